@@ -20,6 +20,17 @@ extern "C" {
         int num_states = 1 << num_qubits; // Total states (2^num_qubits)
         int gate_size = (control == -1) ? 2 : 4; // Determine gate type based on control
 
+        // Load the 2x2 matrix into registers once per launch instead of reading the
+        // gate_matrix port on every iteration (two-qubit gates do not use it)
+        std::complex<float> m[4];
+#pragma HLS ARRAY_PARTITION variable=m complete
+        if (gate_size == 2) {
+            matrix_loop: for (int e = 0; e < 4; ++e) {
+            #pragma HLS PIPELINE II=1
+                m[e] = gate_matrix[e];
+            }
+        }
+
         // Initialize output_state_vector to be a copy of the original state_vector
         // Enable parallel copying
         copy_loop: for (int i = 0; i < num_states; ++i) {
@@ -36,10 +47,10 @@ extern "C" {
                 int flipped_i = i ^ (1 << target);
 
                 if (i < flipped_i) {
-                    output_state_vector[i] = gate_matrix[0 + target_bit] * state_vector[i] +
-                                             gate_matrix[1 - target_bit] * state_vector[flipped_i];
-                    output_state_vector[flipped_i] = gate_matrix[2 + target_bit] * state_vector[i] +
-                                                     gate_matrix[3 - target_bit] * state_vector[flipped_i];
+                    output_state_vector[i] = m[0 + target_bit] * state_vector[i] +
+                                             m[1 - target_bit] * state_vector[flipped_i];
+                    output_state_vector[flipped_i] = m[2 + target_bit] * state_vector[i] +
+                                                     m[3 - target_bit] * state_vector[flipped_i];
                 }
             }
         } 
@@ -11,6 +11,7 @@
 #include <stdexcept>
 #include <algorithm>
 #include <regex>
+#include <chrono>
 
 // Function to parse matrix strings from CSV
 std::vector<std::complex<float>> parse_matrix(const std::string& matrix_str) {
@@ -119,6 +120,23 @@ int main(int argc, char** argv) {
     std::string binaryFile = "./vadd.xclbin";
     int device_index = 0;
 
+    // Parse command line options
+    // --debug-readback: read the state back from the device after every gate (verification only)
+    // --bench <file>: write the kernel time of every gate to <file> as CSV (Scripts/bench.py)
+    bool debug_readback = false;
+    std::string bench_file;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--debug-readback") {
+            debug_readback = true;
+        } else if (arg == "--bench" && i + 1 < argc) {
+            bench_file = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
     // Load device and xclbin
     std::cout << "Opening the device " << device_index << std::endl;
     auto device = xrt::device(device_index);
@@ -154,8 +172,9 @@ int main(int argc, char** argv) {
     //std::cout << "\n";
 
     // Allocate buffers on the device
+    // Both state buffers live in the same bank since they swap input/output roles between gates
     xrt::bo state_bo = xrt::bo(device, state_vector.size() * sizeof(std::complex<float>), kernel.group_id(0));
-    xrt::bo output_state_bo = xrt::bo(device, state_vector.size() * sizeof(std::complex<float>), kernel.group_id(2));
+    xrt::bo output_state_bo = xrt::bo(device, state_vector.size() * sizeof(std::complex<float>), kernel.group_id(0));
     xrt::bo gate_bo = xrt::bo(device, 16 * sizeof(std::complex<float>), kernel.group_id(1));  // Buffer for gates
 
     // Map buffers
@@ -169,7 +188,17 @@ int main(int argc, char** argv) {
     // Synchronize state buffer to device
     state_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
     
-    std::cout << gate_matrices.size() << "\n";
+    std::cout << "Read " << gate_matrices.size() << " gates on " << num_qubits << " qubits\n";
+
+    // Ping-pong buffers: the kernel reads state_bos[src] and writes state_bos[1 - src].
+    // The roles swap after every gate so the state stays resident on the device and
+    // only crosses PCIe once at load and once at readback.
+    xrt::bo state_bos[2] = {state_bo, output_state_bo};
+    int src = 0;
+
+    // Kernel time of every gate, launch to completion
+    std::vector<double> kernel_us;
+    auto start = std::chrono::steady_clock::now();
 
     // Apply gates sequentially
     for (size_t i = 0; i < gate_matrices.size(); ++i) {
@@ -181,35 +210,61 @@ int main(int argc, char** argv) {
         //std::cout << "\n";
 
         // Prepare gate data
-        auto gate_bo_map = gate_bo.map<std::complex<float>*>();
-        std::fill(gate_bo_map, gate_bo_map + 16, std::complex<float>(0.0f, 0.0f));  // Ensure buffer is cleared
-        std::copy(gate_matrices[i].begin(), gate_matrices[i].end(), gate_bo_map);
-        gate_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+        // Only single-qubit gates read their matrix, and only its 4 entries: upload just those
+        if (control_qubits[i] == -1) {
+            gate_bo.write(gate_matrices[i].data(), 4 * sizeof(std::complex<float>), 0);
+            gate_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE, 4 * sizeof(std::complex<float>), 0);
+        }
 
         // Run kernel
-        auto run = kernel(state_bo, gate_bo, output_state_bo, control_qubits[i], target_qubits[i], num_qubits);
+        auto gate_start = std::chrono::steady_clock::now();
+        auto run = kernel(state_bos[src], gate_bo, state_bos[1 - src], control_qubits[i], target_qubits[i], num_qubits);
         run.wait();
+        kernel_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - gate_start).count());
+
+        // Swap input and output roles for the next gate
+        src = 1 - src;
+
+        // Debug: Read back and print the state after each gate application
+        if (debug_readback) {
+            state_bos[src].sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+            auto debug_map = state_bos[src].map<std::complex<float>*>();
+            std::cout << "State after applying gate " << i + 1 << ": ";
+            for (int j = 0; j < state_vector_size; ++j) {
+                std::cout << debug_map[j] << " ";
+            }
+            std::cout << "\n";
+        }
+    }
 
-        // Synchronize back the output state vector
-        output_state_bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
-
-        // Replace the input state vector with the output state
-        std::copy(output_state_bo_map, output_state_bo_map + state_vector.size(), state_bo_map);
-        state_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Applied " << kernel_us.size() << " gates on the FPGA in " << seconds * 1e3 << " ms";
+    if (seconds > 0) {
+        std::cout << " (" << kernel_us.size() / seconds << " gates/s)";
+    }
+    std::cout << "\n";
 
-        // Debug: Print the state after each gate application
-        //std::cout << "State after applying gate " << i + 1 << ": ";
-        //for (int j = 0; j < state_vector_size; ++j) {
-         //   std::cout << state_bo_map[j] << " ";
-        //}
-        std::cout << "\n";
+    if (!bench_file.empty()) {
+        std::ofstream bench(bench_file);
+        if (!bench.is_open()) {
+            std::cerr << "Unable to open " << bench_file << " for writing.\n";
+            return 1;
+        }
+        bench << "gate,control,target,kernel_us\n";
+        for (size_t i = 0; i < kernel_us.size(); ++i) {
+            bench << i << "," << control_qubits[i] << "," << target_qubits[i] << "," << kernel_us[i] << "\n";
+        }
     }
 
+    // Synchronize back the final state vector
+    state_bos[src].sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+    auto final_state_map = state_bos[src].map<std::complex<float>*>();
+
     // Write the final complex state
     std::ofstream outFile("final_state_vector.csv");
     if (outFile.is_open()) {
     for (int i = 0; i < state_vector_size; ++i) {
-        outFile << state_bo_map[i].real() << "+" << state_bo_map[i].imag() << "i" << "\n";
+        outFile << final_state_map[i].real() << "+" << final_state_map[i].imag() << "i" << "\n";
         }
     outFile.close();
     std::cout << "Final state vector written to final_state_vector.csv\n";
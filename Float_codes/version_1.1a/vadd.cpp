@@ -24,6 +24,17 @@ extern "C" {
         
         int num_states = 1 << num_qubits; // Total states (2^num_qubits)
         int gate_size = (control == -1) ? 2 : 4; // Determine gate type based on control   
+
+        // Load the 2x2 matrix into registers once per launch instead of reading the
+        // gate_matrix port on every iteration (two-qubit gates do not use it)
+        std::complex<float> m[4];
+#pragma HLS ARRAY_PARTITION variable=m complete
+        if (gate_size == 2) {
+            matrix_loop: for (int e = 0; e < 4; ++e) {
+            #pragma HLS PIPELINE II=1
+                m[e] = gate_matrix[e];
+            }
+        }
         
         int half_states = num_states / 2; // States in each half
 /*
@@ -46,35 +57,35 @@ if (gate_size == 2) {
             // Handle both states (i and flipped_i) only once
             if (i < half_states && flipped_i < half_states) {
                 // Both indices in the first half
-                output_state_1[i] = gate_matrix[target_bit * 2] * input_state_1[i] +
-                                    gate_matrix[1 - target_bit] * input_state_1[flipped_i];
-                output_state_1[flipped_i] = gate_matrix[2 + target_bit * 2] * input_state_1[i] +
-                                            gate_matrix[3 - target_bit] * input_state_1[flipped_i];
+                output_state_1[i] = m[target_bit * 2] * input_state_1[i] +
+                                    m[1 - target_bit] * input_state_1[flipped_i];
+                output_state_1[flipped_i] = m[2 + target_bit * 2] * input_state_1[i] +
+                                            m[3 - target_bit] * input_state_1[flipped_i];
             } else if (i >= half_states && flipped_i >= half_states) {
                 // Both indices in the second half
                 int local_i = i - half_states;
                 int local_flipped_i = flipped_i - half_states;
 
-                output_state_2[local_i] = gate_matrix[target_bit * 2] * input_state_2[local_i] +
-                                          gate_matrix[1 - target_bit] * input_state_2[local_flipped_i];
-                output_state_2[local_flipped_i] = gate_matrix[2 + target_bit * 2] * input_state_2[local_i] +
-                                                  gate_matrix[3 - target_bit] * input_state_2[local_flipped_i];
+                output_state_2[local_i] = m[target_bit * 2] * input_state_2[local_i] +
+                                          m[1 - target_bit] * input_state_2[local_flipped_i];
+                output_state_2[local_flipped_i] = m[2 + target_bit * 2] * input_state_2[local_i] +
+                                                  m[3 - target_bit] * input_state_2[local_flipped_i];
             } else if (i < half_states && flipped_i >= half_states) {
                 // i in the first half, flipped_i in the second half
                 int local_flipped_i = flipped_i - half_states;
 
-                output_state_1[i] = gate_matrix[target_bit * 2] * input_state_1[i] +
-                                    gate_matrix[1 - target_bit] * input_state_2[local_flipped_i];
-                output_state_2[local_flipped_i] = gate_matrix[2 + target_bit * 2] * input_state_1[i] +
-                                                  gate_matrix[3 - target_bit] * input_state_2[local_flipped_i];
+                output_state_1[i] = m[target_bit * 2] * input_state_1[i] +
+                                    m[1 - target_bit] * input_state_2[local_flipped_i];
+                output_state_2[local_flipped_i] = m[2 + target_bit * 2] * input_state_1[i] +
+                                                  m[3 - target_bit] * input_state_2[local_flipped_i];
             } else if (i >= half_states && flipped_i < half_states) {
                 // i in the second half, flipped_i in the first half
                 int local_i = i - half_states;
 
-                output_state_2[local_i] = gate_matrix[target_bit * 2] * input_state_2[local_i] +
-                                          gate_matrix[1 - target_bit] * input_state_1[flipped_i];
-                output_state_1[flipped_i] = gate_matrix[2 + target_bit * 2] * input_state_2[local_i] +
-                                            gate_matrix[3 - target_bit] * input_state_1[flipped_i];
+                output_state_2[local_i] = m[target_bit * 2] * input_state_2[local_i] +
+                                          m[1 - target_bit] * input_state_1[flipped_i];
+                output_state_1[flipped_i] = m[2 + target_bit * 2] * input_state_2[local_i] +
+                                            m[3 - target_bit] * input_state_1[flipped_i];
             }
         }
     }
@@ -21,6 +21,17 @@ extern "C" {
         int num_states = 1 << num_qubits; // Total states (2^num_qubits)
         int gate_size = (control == -1) ? 2 : 4; // Determine gate type based on control
 
+        // Load the 2x2 matrix into registers once per launch instead of reading the
+        // gate_matrix port on every iteration (two-qubit gates do not use it)
+        std::complex<float> m[4];
+#pragma HLS ARRAY_PARTITION variable=m complete
+        if (gate_size == 2) {
+            matrix_loop: for (int e = 0; e < 4; ++e) {
+            #pragma HLS PIPELINE II=1
+                m[e] = gate_matrix[e];
+            }
+        }
+
         
 if (gate_size == 2) {
     single_qubit_loop: for (int i = 0; i < num_states; ++i) {
@@ -34,13 +45,13 @@ if (gate_size == 2) {
 
         if (bit == 0) {
             // When the target bit is 0, i is the lower index.
-            output_state_vector[i] = gate_matrix[0] * state_vector[i] +
-                                       gate_matrix[1] * state_vector[partner];
+            output_state_vector[i] = m[0] * state_vector[i] +
+                                       m[1] * state_vector[partner];
         }
         else {
             // When the target bit is 1, i is the higher index.
-            output_state_vector[i] = gate_matrix[2] * state_vector[partner] +
-                                       gate_matrix[3] * state_vector[i];
+            output_state_vector[i] = m[2] * state_vector[partner] +
+                                       m[3] * state_vector[i];
         }
     }
 }
@@ -0,0 +1,152 @@
+#ifndef AMP_TYPES_H
+#define AMP_TYPES_H
+
+// Scalar precision and state layout, chosen at compile time and shared by host.cpp and
+// vadd.cpp (pass the same -D flags to g++ and to v++ for every kernel).
+//
+// Precision: define at most one of
+//   AMP_PRECISION_HALF       IEEE float16 (hls_half.h in the kernels, half.hpp on the host)
+//   AMP_PRECISION_BFLOAT16   bfloat16 (amp_bfloat16 below, arithmetic done in float)
+//   AMP_PRECISION_FIXED      ap_fixed<AMP_FIXED_WIDTH, AMP_FIXED_INT>
+// The default is IEEE float. amp_t is std::complex of that scalar everywhere: state buffers,
+// gate matrices, the CPU backend and the binary state file, so every kernel and host path
+// runs the same code at every precision.
+//
+// Layout: AMP_LAYOUT_SOA stores the state buffers of the per-gate vadd kernel (and its
+// compute units in --cus mode) as two planes, the 2^n real parts followed by the 2^n
+// imaginary parts. The default, and the layout of every other kernel, is an amp_t array.
+
+#include <complex>
+#include <cstring>
+
+#if (defined(AMP_PRECISION_HALF) + defined(AMP_PRECISION_BFLOAT16) + defined(AMP_PRECISION_FIXED)) > 1
+#error "Define at most one of AMP_PRECISION_HALF, AMP_PRECISION_BFLOAT16 and AMP_PRECISION_FIXED"
+#endif
+
+#if defined(AMP_PRECISION_HALF)
+
+#if defined(__VITIS_HLS__) || defined(__SYNTHESIS__)
+#include <hls_half.h>
+typedef half amp_scalar_t;
+#else
+#include "half.hpp"
+typedef half_float::half amp_scalar_t;
+#endif
+#define AMP_SCALAR_BITS 16
+#define AMP_PRECISION_NAME "half"
+#define AMP_PRECISION_ID 1
+
+#elif defined(AMP_PRECISION_BFLOAT16)
+
+// bfloat16: the top 16 bits of an IEEE float. Values are rounded to nearest even when
+// stored and every operation is done in float.
+struct amp_bfloat16 {
+    unsigned short bits;
+
+    amp_bfloat16() : bits(0) {}
+    explicit amp_bfloat16(float f) {
+        union { unsigned int u; float f; } value;
+        value.f = f;
+        bits = static_cast<unsigned short>((value.u + 0x7fff + ((value.u >> 16) & 1)) >> 16);
+    }
+    operator float() const {
+        union { unsigned int u; float f; } value;
+        value.u = static_cast<unsigned int>(bits) << 16;
+        return value.f;
+    }
+
+    friend amp_bfloat16 operator+(amp_bfloat16 a, amp_bfloat16 b) { return amp_bfloat16(float(a) + float(b)); }
+    friend amp_bfloat16 operator-(amp_bfloat16 a, amp_bfloat16 b) { return amp_bfloat16(float(a) - float(b)); }
+    friend amp_bfloat16 operator*(amp_bfloat16 a, amp_bfloat16 b) { return amp_bfloat16(float(a) * float(b)); }
+    friend amp_bfloat16 operator/(amp_bfloat16 a, amp_bfloat16 b) { return amp_bfloat16(float(a) / float(b)); }
+    amp_bfloat16 operator-() const { return amp_bfloat16(-float(*this)); }
+    amp_bfloat16& operator+=(amp_bfloat16 b) { return *this = *this + b; }
+    amp_bfloat16& operator-=(amp_bfloat16 b) { return *this = *this - b; }
+    amp_bfloat16& operator*=(amp_bfloat16 b) { return *this = *this * b; }
+    amp_bfloat16& operator/=(amp_bfloat16 b) { return *this = *this / b; }
+};
+
+typedef amp_bfloat16 amp_scalar_t;
+#define AMP_SCALAR_BITS 16
+#define AMP_PRECISION_NAME "bfloat16"
+#define AMP_PRECISION_ID 2
+
+#elif defined(AMP_PRECISION_FIXED)
+
+// Total and integer bits. The integer part must hold the qubit positions GATE_PERMUTE
+// stores in its matrix block (up to 32, plus the sign bit), and the width must be 16 or 32
+// bits so that amplitudes pack into the 512-bit words of vadd_wide.
+#ifndef AMP_FIXED_WIDTH
+#define AMP_FIXED_WIDTH 32
+#endif
+#ifndef AMP_FIXED_INT
+#define AMP_FIXED_INT 7
+#endif
+#if AMP_FIXED_WIDTH != 16 && AMP_FIXED_WIDTH != 32
+#error "AMP_FIXED_WIDTH must be 16 or 32"
+#endif
+
+#include <ap_fixed.h>
+typedef ap_fixed<AMP_FIXED_WIDTH, AMP_FIXED_INT> amp_scalar_t;
+#define AMP_SCALAR_BITS AMP_FIXED_WIDTH
+#define AMP_PRECISION_NAME "fixed"
+#define AMP_PRECISION_ID (3 | (AMP_FIXED_WIDTH << 8) | (AMP_FIXED_INT << 16))
+
+#else
+
+#define AMP_PRECISION_FLOAT
+typedef float amp_scalar_t;
+#define AMP_SCALAR_BITS 32
+#define AMP_PRECISION_NAME "float"
+#define AMP_PRECISION_ID 0
+
+#endif
+
+// AMP_PRECISION_ID tags files that store amp_t as-is (circuit_file.h); 0 is float, so files
+// written before the precision choice existed keep loading in float builds
+
+// Amplitude type of the state vector and the gate matrices
+typedef std::complex<amp_scalar_t> amp_t;
+
+// Function to build an amplitude from float parts (the half and bfloat16 scalars only
+// convert from float explicitly)
+inline amp_t make_amp(float re, float im) {
+    return amp_t(amp_scalar_t(re), amp_scalar_t(im));
+}
+
+// Function to widen an amplitude to complex<float> for host-side comparisons and output
+inline std::complex<float> amp_to_float(const amp_t& a) {
+    return std::complex<float>(static_cast<float>(a.real()), static_cast<float>(a.imag()));
+}
+
+// Function to get the raw AMP_SCALAR_BITS bits of a scalar (low bits of the result)
+inline unsigned int amp_scalar_to_bits(amp_scalar_t x) {
+#if defined(AMP_PRECISION_FIXED)
+    return static_cast<unsigned int>(x.range(AMP_FIXED_WIDTH - 1, 0));
+#elif defined(AMP_PRECISION_BFLOAT16)
+    return x.bits;
+#else
+    unsigned int bits = 0;
+    std::memcpy(&bits, &x, AMP_SCALAR_BITS / 8);  // Little-endian: the low bytes
+    return bits;
+#endif
+}
+
+// Function to build a scalar from its raw AMP_SCALAR_BITS bits
+inline amp_scalar_t amp_scalar_from_bits(unsigned int bits) {
+#if defined(AMP_PRECISION_FIXED)
+    amp_scalar_t x;
+    x.range(AMP_FIXED_WIDTH - 1, 0) = bits;
+    return x;
+#elif defined(AMP_PRECISION_BFLOAT16)
+    amp_scalar_t x;
+    x.bits = static_cast<unsigned short>(bits);
+    return x;
+#else
+    amp_scalar_t x;
+    std::memcpy(&x, &bits, AMP_SCALAR_BITS / 8);
+    return x;
+#endif
+}
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef CIRCUIT_FILE_H
+#define CIRCUIT_FILE_H
+
+// Compiled circuit file (.q2sv): the packed gate list of gate_desc.h stored as-is, so the
+// host can mmap it and upload the gate records and the matrix pool without parsing.
+//
+// Layout (native byte order, sections aligned to CIRCUIT_FILE_ALIGNMENT bytes):
+//   circuit_file_header
+//   num_gates          gate_desc records
+//   num_matrix_entries amp_t matrix pool entries (GATE_MATRIX_SIZE per record)
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "gate_desc.h"
+
+#define CIRCUIT_FILE_MAGIC "Q2SVCIRC"
+#define CIRCUIT_FILE_VERSION 1
+#define CIRCUIT_FILE_ALIGNMENT 64
+
+// Header flags
+#define CIRCUIT_FILE_FUSED 0x1 // Single-qubit gate fusion was applied when the file was written
+
+struct circuit_file_header {
+    char magic[8];                  // CIRCUIT_FILE_MAGIC, not null-terminated
+    uint32_t version;               // CIRCUIT_FILE_VERSION
+    uint32_t flags;                 // CIRCUIT_FILE_* flags
+    uint32_t gate_record_size;      // sizeof(gate_desc) of the writer
+    uint32_t amp_size;              // sizeof(amp_t) of the writer
+    int32_t num_qubits;             // Number of qubits
+    uint32_t precision;             // AMP_PRECISION_ID of the writer (amp_types.h)
+    uint64_t num_gates;             // Number of gate_desc records
+    uint64_t num_matrix_entries;    // Number of amp_t entries in the matrix pool
+    uint64_t gates_offset;          // Byte offset of the first gate record
+    uint64_t matrices_offset;       // Byte offset of the matrix pool
+};
+
+inline uint64_t circuit_file_align(uint64_t offset) {
+    return (offset + CIRCUIT_FILE_ALIGNMENT - 1) & ~static_cast<uint64_t>(CIRCUIT_FILE_ALIGNMENT - 1);
+}
+
+// Function to write a packed gate list to a compiled circuit file
+inline void write_circuit_file(const std::string& filename, const gate_desc* gates, size_t num_gates,
+                               const amp_t* gate_matrices, size_t num_matrix_entries, int num_qubits, uint32_t flags) {
+    circuit_file_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CIRCUIT_FILE_MAGIC, sizeof(header.magic));
+    header.version = CIRCUIT_FILE_VERSION;
+    header.flags = flags;
+    header.gate_record_size = sizeof(gate_desc);
+    header.amp_size = sizeof(amp_t);
+    header.precision = AMP_PRECISION_ID;
+    header.num_qubits = num_qubits;
+    header.num_gates = num_gates;
+    header.num_matrix_entries = num_matrix_entries;
+    header.gates_offset = circuit_file_align(sizeof(header));
+    header.matrices_offset = circuit_file_align(header.gates_offset + num_gates * sizeof(gate_desc));
+
+    FILE* file = std::fopen(filename.c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("Failed to open " + filename + " for writing");
+    }
+
+    static const char padding[CIRCUIT_FILE_ALIGNMENT] = {};
+    uint64_t gates_bytes = num_gates * sizeof(gate_desc);
+    uint64_t matrices_bytes = num_matrix_entries * sizeof(amp_t);
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && std::fwrite(padding, 1, header.gates_offset - sizeof(header), file) == header.gates_offset - sizeof(header);
+    ok = ok && std::fwrite(gates, 1, gates_bytes, file) == gates_bytes;
+    ok = ok && std::fwrite(padding, 1, header.matrices_offset - header.gates_offset - gates_bytes, file) ==
+                   header.matrices_offset - header.gates_offset - gates_bytes;
+    ok = ok && std::fwrite(gate_matrices, 1, matrices_bytes, file) == matrices_bytes;
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok) {
+        throw std::runtime_error("Failed to write " + filename);
+    }
+}
+
+// Read-only mapping of a compiled circuit file. gates() and matrices() point straight into
+// the mapping and stay valid for the lifetime of the object.
+class mapped_circuit {
+public:
+    explicit mapped_circuit(const std::string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open file");
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(circuit_file_header)) {
+            ::close(fd);
+            throw std::runtime_error("Not a compiled circuit file (too short)");
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("Failed to mmap file");
+        }
+        data_ = static_cast<const char*>(data);
+        // The records are read front to back during upload
+        ::madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+
+        try {
+            validate();
+        } catch (...) {
+            ::munmap(const_cast<char*>(data_), size_);
+            throw;
+        }
+    }
+
+    ~mapped_circuit() {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+
+    mapped_circuit(const mapped_circuit&) = delete;
+    mapped_circuit& operator=(const mapped_circuit&) = delete;
+
+    const circuit_file_header& header() const { return *reinterpret_cast<const circuit_file_header*>(data_); }
+    const gate_desc* gates() const { return reinterpret_cast<const gate_desc*>(data_ + header().gates_offset); }
+    const amp_t* matrices() const { return reinterpret_cast<const amp_t*>(data_ + header().matrices_offset); }
+    size_t num_gates() const { return header().num_gates; }
+    size_t num_matrix_entries() const { return header().num_matrix_entries; }
+    int num_qubits() const { return header().num_qubits; }
+
+private:
+    // Function to check the header against this build and the file size
+    void validate() const {
+        const circuit_file_header& h = header();
+        if (std::memcmp(h.magic, CIRCUIT_FILE_MAGIC, sizeof(h.magic)) != 0) {
+            throw std::runtime_error("Not a compiled circuit file (bad magic)");
+        }
+        if (h.version != CIRCUIT_FILE_VERSION) {
+            throw std::runtime_error("Unsupported compiled circuit version " + std::to_string(h.version));
+        }
+        if (h.gate_record_size != sizeof(gate_desc) || h.amp_size != sizeof(amp_t) || h.precision != AMP_PRECISION_ID) {
+            throw std::runtime_error("Compiled circuit was written with a different gate_desc/amp_t layout or precision");
+        }
+        if (h.num_qubits < 1 || h.num_qubits > 33) {
+            throw std::runtime_error("Invalid number of qubits " + std::to_string(h.num_qubits));
+        }
+        if (h.gates_offset % CIRCUIT_FILE_ALIGNMENT != 0 || h.matrices_offset % CIRCUIT_FILE_ALIGNMENT != 0 ||
+            h.gates_offset + h.num_gates * sizeof(gate_desc) > size_ ||
+            h.matrices_offset + h.num_matrix_entries * sizeof(amp_t) > size_ ||
+            h.num_matrix_entries < h.num_gates * GATE_MATRIX_SIZE) {
+            throw std::runtime_error("Compiled circuit sections do not fit the file");
+        }
+        // Gate records index the pool and the state; reject anything the kernels would overrun on
+        const gate_desc* g = gates();
+        for (uint64_t i = 0; i < h.num_gates; ++i) {
+            if (g[i].target < 0 || g[i].target >= h.num_qubits || g[i].control < -1 || g[i].control >= h.num_qubits ||
+                g[i].matrix < 0 || static_cast<uint64_t>(g[i].matrix + 1) * GATE_MATRIX_SIZE > h.num_matrix_entries) {
+                throw std::runtime_error("Invalid gate record " + std::to_string(i));
+            }
+        }
+    }
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+#endif
@@ -0,0 +1,302 @@
+#ifndef CIRCUIT_GENERATOR_H
+#define CIRCUIT_GENERATOR_H
+
+// Synthetic circuits for scaling benchmarks and CPU/FPGA cross-checks, generated straight
+// into the packed gate list (see gate_desc.h), so no QASM or CSV file is needed:
+//   random    layers of random u3 gates and cx/cz/cp gates on qubits drawn from `targets`
+//   qft       quantum Fourier transform on a random basis state (depth and targets unused)
+//   ghz       h and a chain of cx gates (depth and targets unused)
+//   qv        quantum volume: per layer a random pairing of the qubits, a random 4x4
+//             unitary on each pair (targets unused)
+//   diagonal  h on every qubit, layers of rz/cp/rzz gates on qubits drawn from `targets`,
+//             h on every qubit again
+// The spec is "<kind>[,qubits=<n>][,depth=<layers>][,seed=<n>][,targets=uniform|high|low]".
+// high (low) draws most qubits from the top (bottom) eighth of the register, the
+// large-stride (small-stride) case for the kernels. The random numbers come from a fixed
+// generator (splitmix64) rather than <random> distributions, so a spec gives the same
+// circuit on every platform and standard library.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "gate_desc.h"
+#include "gate_list.h"
+#include "qasm_parser.h"
+
+// Parsed generator spec
+struct generator_spec {
+    std::string kind;       // random, qft, ghz, qv or diagonal
+    int num_qubits;         // Register size
+    int depth;              // Layers (random, qv, diagonal)
+    uint64_t seed;          // Random seed
+    std::string targets;    // Qubit distribution: uniform, high or low
+};
+
+// Function to parse a generator spec (see above); depth defaults to the number of qubits
+inline generator_spec parse_generator_spec(const std::string& text) {
+    generator_spec spec = {"", 20, 0, 1, "uniform"};
+    std::stringstream stream(text);
+    std::string field;
+    std::getline(stream, spec.kind, ',');
+    if (spec.kind != "random" && spec.kind != "qft" && spec.kind != "ghz" && spec.kind != "qv" && spec.kind != "diagonal") {
+        throw std::runtime_error("unknown circuit kind '" + spec.kind + "' (random, qft, ghz, qv or diagonal)");
+    }
+    while (std::getline(stream, field, ',')) {
+        size_t equals = field.find('=');
+        std::string key = field.substr(0, equals);
+        std::string value = (equals == std::string::npos) ? "" : field.substr(equals + 1);
+        try {
+            if (key == "qubits") {
+                spec.num_qubits = std::stoi(value);
+            } else if (key == "depth") {
+                spec.depth = std::stoi(value);
+            } else if (key == "seed") {
+                spec.seed = std::stoull(value);
+            } else if (key == "targets") {
+                spec.targets = value;
+            } else {
+                throw std::runtime_error("unknown field '" + field + "'");
+            }
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("invalid value in '" + field + "'");
+        }
+    }
+    if (spec.num_qubits < 2 || spec.num_qubits > 40) {
+        throw std::runtime_error("qubits must be between 2 and 40");
+    }
+    if (spec.depth < 0) {
+        throw std::runtime_error("depth must not be negative");
+    }
+    if (spec.targets != "uniform" && spec.targets != "high" && spec.targets != "low") {
+        throw std::runtime_error("unknown target distribution '" + spec.targets + "' (uniform, high or low)");
+    }
+    spec.depth = (spec.depth == 0) ? spec.num_qubits : spec.depth;
+    return spec;
+}
+
+// splitmix64 random numbers
+struct generator_rng {
+    uint64_t state;
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    // Uniform in [0, 1)
+    double uniform() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+    // Uniform in [0, n)
+    int below(int n) {
+        return static_cast<int>(next() % static_cast<uint64_t>(n));
+    }
+    // Uniform angle in [0, 2 pi)
+    double angle() {
+        return 2.0 * M_PI * uniform();
+    }
+    // Standard normal (Box-Muller)
+    double normal() {
+        double u1 = 1.0 - uniform();
+        return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * uniform());
+    }
+};
+
+// Builds one circuit into the gate list
+class circuit_generator {
+public:
+    circuit_generator(const generator_spec& spec, std::vector<gate_desc>& gates, std::vector<amp_t>& gate_matrices)
+        : spec_(spec), gates_(gates), gate_matrices_(gate_matrices), rng_{spec.seed} {}
+
+    void generate() {
+        if (spec_.kind == "random") {
+            random_layers();
+        } else if (spec_.kind == "qft") {
+            qft();
+        } else if (spec_.kind == "ghz") {
+            ghz();
+        } else if (spec_.kind == "qv") {
+            quantum_volume();
+        } else {
+            diagonal_layers();
+        }
+    }
+
+private:
+    const generator_spec& spec_;
+    std::vector<gate_desc>& gates_;
+    std::vector<amp_t>& gate_matrices_;
+    generator_rng rng_;
+
+    // Function to append a 2x2 (control == -1) or 4x4 gate, classified like the parsed ones
+    void append(const qasm_matrix& matrix, int control, int target) {
+        gate_desc gate;
+        gate.control = control;
+        gate.target = target;
+        gate.matrix = static_cast<int>(gates_.size());
+
+        size_t offset = gate_matrices_.size();
+        gate_matrices_.resize(offset + GATE_MATRIX_SIZE, make_amp(0.0f, 0.0f));
+        for (int k = 0; k < matrix.size * matrix.size; ++k) {
+            gate_matrices_[offset + k] = make_amp(static_cast<float>(matrix.m[k].real()), static_cast<float>(matrix.m[k].imag()));
+        }
+
+        classify_gate(gate, &gate_matrices_[offset]);
+        gates_.push_back(gate);
+    }
+
+    // Function to append a qelib1.inc gate by name
+    void append(const std::string& name, const std::vector<double>& params, int control, int target) {
+        qasm_matrix matrix;
+        qasm_native_matrix(name, params, matrix);
+        append(matrix, control, target);
+    }
+
+    // Function to draw a qubit from the target distribution
+    int pick_qubit() {
+        int n = spec_.num_qubits;
+        if (spec_.targets == "uniform") {
+            return rng_.below(n);
+        }
+        // Exponential distance from the chosen end, mean n/8 (at least one qubit)
+        double mean = std::max(1.0, n / 8.0);
+        int distance = static_cast<int>(-std::log(1.0 - rng_.uniform()) * mean);
+        distance = std::min(distance, n - 1);
+        return (spec_.targets == "high") ? n - 1 - distance : distance;
+    }
+
+    // Function to draw two different qubits from the target distribution
+    void pick_pair(int& control, int& target) {
+        control = pick_qubit();
+        do {
+            target = pick_qubit();
+        } while (target == control);
+    }
+
+    void random_layers() {
+        static const char* const two_qubit_gates[] = {"cx", "cz", "cp"};
+        for (int layer = 0; layer < spec_.depth; ++layer) {
+            for (int k = 0; k < spec_.num_qubits; ++k) {
+                // One draw per statement: argument evaluation order is unspecified
+                int target = pick_qubit();
+                append("u3", {rng_.angle(), rng_.angle(), rng_.angle()}, -1, target);
+            }
+            for (int k = 0; k < spec_.num_qubits / 2; ++k) {
+                int control, target;
+                pick_pair(control, target);
+                const char* name = two_qubit_gates[rng_.below(3)];
+                append(name, (name[1] == 'p') ? std::vector<double>{rng_.angle()} : std::vector<double>{}, control, target);
+            }
+        }
+    }
+
+    void qft() {
+        int n = spec_.num_qubits;
+        for (int q = 0; q < n; ++q) {
+            if (rng_.below(2)) {
+                append("x", {}, -1, q);
+            }
+        }
+        for (int j = n - 1; j >= 0; --j) {
+            append("h", {}, -1, j);
+            for (int k = j - 1; k >= 0; --k) {
+                append("cp", {M_PI / std::ldexp(1.0, j - k)}, k, j);
+            }
+        }
+        for (int q = 0; q < n / 2; ++q) {
+            append("swap", {}, q, n - 1 - q);
+        }
+    }
+
+    void ghz() {
+        append("h", {}, -1, 0);
+        for (int q = 0; q + 1 < spec_.num_qubits; ++q) {
+            append("cx", {}, q, q + 1);
+        }
+    }
+
+    // Function to build a random 4x4 unitary: Gram-Schmidt on a complex Gaussian matrix
+    qasm_matrix random_unitary() {
+        qasm_matrix u;
+        u.size = 4;
+        for (int row = 0; row < 4; ++row) {
+            qasm_complex* r = u.m + row * 4;
+            for (int col = 0; col < 4; ++col) {
+                double re = rng_.normal();
+                r[col] = qasm_complex(re, rng_.normal());
+            }
+            for (int prev = 0; prev < row; ++prev) {
+                const qasm_complex* p = u.m + prev * 4;
+                qasm_complex dot = 0.0;
+                for (int col = 0; col < 4; ++col) {
+                    dot += std::conj(p[col]) * r[col];
+                }
+                for (int col = 0; col < 4; ++col) {
+                    r[col] -= dot * p[col];
+                }
+            }
+            double norm = 0.0;
+            for (int col = 0; col < 4; ++col) {
+                norm += std::norm(r[col]);
+            }
+            for (int col = 0; col < 4; ++col) {
+                r[col] /= std::sqrt(norm);
+            }
+        }
+        return u;
+    }
+
+    void quantum_volume() {
+        int n = spec_.num_qubits;
+        std::vector<int> order(n);
+        for (int layer = 0; layer < spec_.depth; ++layer) {
+            for (int q = 0; q < n; ++q) {
+                order[q] = q;
+            }
+            for (int q = n - 1; q > 0; --q) {
+                std::swap(order[q], order[rng_.below(q + 1)]);
+            }
+            for (int k = 0; k + 1 < n; k += 2) {
+                append(random_unitary(), order[k], order[k + 1]);
+            }
+        }
+    }
+
+    void diagonal_layers() {
+        for (int q = 0; q < spec_.num_qubits; ++q) {
+            append("h", {}, -1, q);
+        }
+        for (int layer = 0; layer < spec_.depth; ++layer) {
+            for (int k = 0; k < spec_.num_qubits; ++k) {
+                int choice = rng_.below(3);
+                if (choice == 0) {
+                    int target = pick_qubit();
+                    append("rz", {rng_.angle()}, -1, target);
+                    continue;
+                }
+                int control, target;
+                pick_pair(control, target);
+                append((choice == 1) ? "cp" : "rzz", {rng_.angle()}, control, target);
+            }
+        }
+        for (int q = 0; q < spec_.num_qubits; ++q) {
+            append("h", {}, -1, q);
+        }
+    }
+};
+
+// Function to generate the circuit of a spec into the packed gate list and number of qubits
+inline void generate_circuit(const generator_spec& spec, std::vector<gate_desc>& gates, std::vector<amp_t>& gate_matrices, int& num_qubits) {
+    gates.clear();
+    gate_matrices.clear();
+    circuit_generator generator(spec, gates, gate_matrices);
+    generator.generate();
+    num_qubits = spec.num_qubits;
+}
+
+#endif
@@ -0,0 +1,250 @@
+#ifndef CPU_BACKEND_H
+#define CPU_BACKEND_H
+
+// CPU execution backend for the packed gate list (see gate_desc.h), for machines without
+// an Alveo card and as a throughput baseline for the kernels.
+//
+// Gates are applied in place on one state buffer. Every loop runs over independent
+// amplitude groups (pairs for single-qubit gates, quadruples for two-qubit gates), split
+// across threads with OpenMP and vectorized with AVX-512 or AVX2+FMA when the compiler
+// targets them (e.g. -fopenmp -march=native). A group is vectorized when all of its gate
+// qubits are at or above CPU_SIMD_LOG2, so that each lane block is contiguous in memory;
+// gates on the lowest qubits fall back to the scalar path. The vector paths are written for
+// complex<float>; the other precisions of amp_types.h always take the scalar path.
+
+#include <complex>
+#include <cstdint>
+#include "gate_desc.h"
+
+#if defined(AMP_PRECISION_FLOAT) && (defined(__AVX512F__) || defined(__AVX2__))
+#include <immintrin.h>
+#endif
+
+#if defined(AMP_PRECISION_FLOAT) && defined(__AVX512F__)
+#define CPU_SIMD_WIDTH 8        // Amplitudes per vector register
+#define CPU_SIMD_LOG2 3
+#elif defined(AMP_PRECISION_FLOAT) && defined(__AVX2__) && defined(__FMA__)
+#define CPU_SIMD_WIDTH 4
+#define CPU_SIMD_LOG2 2
+#else
+#define CPU_SIMD_WIDTH 1
+#define CPU_SIMD_LOG2 0
+#endif
+
+// States smaller than this are updated by a single thread
+#define CPU_PARALLEL_MIN_STATES (1 << 14)
+
+// Vector of W consecutive amplitudes and the complex arithmetic the gate loops need
+template <int W> struct cpu_lanes;
+
+template <> struct cpu_lanes<1> {
+    typedef amp_t reg;
+    static reg load(const amp_t* p) { return *p; }
+    static void store(amp_t* p, reg v) { *p = v; }
+    static reg add(reg a, reg b) { return a + b; }
+    static reg cmul(const amp_t& a, reg x) { return a * x; }
+};
+
+#if defined(AMP_PRECISION_FLOAT) && defined(__AVX2__) && defined(__FMA__)
+template <> struct cpu_lanes<4> {
+    typedef __m256 reg;
+    static reg load(const amp_t* p) { return _mm256_loadu_ps(reinterpret_cast<const float*>(p)); }
+    static void store(amp_t* p, reg v) { _mm256_storeu_ps(reinterpret_cast<float*>(p), v); }
+    static reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+    // (ar + i ai)(xr + i xi): even lanes ar*xr - ai*xi, odd lanes ar*xi + ai*xr
+    static reg cmul(const amp_t& a, reg x) {
+        reg swapped = _mm256_shuffle_ps(x, x, 0xB1);
+        return _mm256_fmaddsub_ps(_mm256_set1_ps(a.real()), x, _mm256_mul_ps(_mm256_set1_ps(a.imag()), swapped));
+    }
+};
+#endif
+
+#if defined(AMP_PRECISION_FLOAT) && defined(__AVX512F__)
+template <> struct cpu_lanes<8> {
+    typedef __m512 reg;
+    static reg load(const amp_t* p) { return _mm512_loadu_ps(reinterpret_cast<const float*>(p)); }
+    static void store(amp_t* p, reg v) { _mm512_storeu_ps(reinterpret_cast<float*>(p), v); }
+    static reg add(reg a, reg b) { return _mm512_add_ps(a, b); }
+    static reg cmul(const amp_t& a, reg x) {
+        reg swapped = _mm512_shuffle_ps(x, x, 0xB1);
+        return _mm512_fmaddsub_ps(_mm512_set1_ps(a.real()), x, _mm512_mul_ps(_mm512_set1_ps(a.imag()), swapped));
+    }
+};
+#endif
+
+// Insert a zero bit at position pos of k
+inline int64_t cpu_insert_zero_bit(int64_t k, int pos) {
+    return ((k >> pos) << (pos + 1)) | (k & ((int64_t(1) << pos) - 1));
+}
+
+// 2x2 matrix on the target qubit
+template <int W>
+void cpu_single_qubit(amp_t* state, const amp_t* m, int target, int num_qubits) {
+    typedef cpu_lanes<W> L;
+    const int64_t num_pairs = int64_t(1) << (num_qubits - 1);
+    const int64_t stride = int64_t(1) << target;
+
+    #pragma omp parallel for schedule(static) if (num_pairs >= CPU_PARALLEL_MIN_STATES)
+    for (int64_t k = 0; k < num_pairs; k += W) {
+        int64_t i0 = cpu_insert_zero_bit(k, target);
+        typename L::reg x0 = L::load(state + i0);
+        typename L::reg x1 = L::load(state + i0 + stride);
+        L::store(state + i0, L::add(L::cmul(m[0], x0), L::cmul(m[1], x1)));
+        L::store(state + i0 + stride, L::add(L::cmul(m[2], x0), L::cmul(m[3], x1)));
+    }
+}
+
+// 2x2 matrix on the target where the control bit is 1; GATE_CX swaps the pair instead
+template <int W>
+void cpu_controlled(amp_t* state, const amp_t* m, bool is_cx, int control, int target, int num_qubits) {
+    typedef cpu_lanes<W> L;
+    const int64_t num_groups = int64_t(1) << (num_qubits - 2);
+    const int low = (control < target) ? control : target;
+    const int high = (control < target) ? target : control;
+    const int64_t stride = int64_t(1) << target;
+
+    #pragma omp parallel for schedule(static) if (num_groups >= CPU_PARALLEL_MIN_STATES)
+    for (int64_t k = 0; k < num_groups; k += W) {
+        int64_t i0 = cpu_insert_zero_bit(cpu_insert_zero_bit(k, low), high) | (int64_t(1) << control);
+        typename L::reg x0 = L::load(state + i0);
+        typename L::reg x1 = L::load(state + i0 + stride);
+        if (is_cx) {
+            L::store(state + i0, x1);
+            L::store(state + i0 + stride, x0);
+        } else {
+            L::store(state + i0, L::add(L::cmul(m[0], x0), L::cmul(m[1], x1)));
+            L::store(state + i0 + stride, L::add(L::cmul(m[2], x0), L::cmul(m[3], x1)));
+        }
+    }
+}
+
+// General 4x4 matrix; local index bit 0 is the control qubit, bit 1 the target qubit
+template <int W>
+void cpu_two_qubit(amp_t* state, const amp_t* m, int control, int target, int num_qubits) {
+    typedef cpu_lanes<W> L;
+    const int64_t num_groups = int64_t(1) << (num_qubits - 2);
+    const int low = (control < target) ? control : target;
+    const int high = (control < target) ? target : control;
+    const int64_t offset[4] = {0, int64_t(1) << control, int64_t(1) << target,
+                               (int64_t(1) << control) | (int64_t(1) << target)};
+
+    #pragma omp parallel for schedule(static) if (num_groups >= CPU_PARALLEL_MIN_STATES)
+    for (int64_t k = 0; k < num_groups; k += W) {
+        int64_t base = cpu_insert_zero_bit(cpu_insert_zero_bit(k, low), high);
+        typename L::reg in[4];
+        for (int l = 0; l < 4; ++l) {
+            in[l] = L::load(state + base + offset[l]);
+        }
+        for (int row = 0; row < 4; ++row) {
+            typename L::reg acc = L::add(L::add(L::cmul(m[row * 4 + 0], in[0]), L::cmul(m[row * 4 + 1], in[1])),
+                                         L::add(L::cmul(m[row * 4 + 2], in[2]), L::cmul(m[row * 4 + 3], in[3])));
+            L::store(state + base + offset[row], acc);
+        }
+    }
+}
+
+// Diagonal gate: one phase per amplitude, selected by the target (and control) bits
+template <int W>
+void cpu_diagonal(amp_t* state, const amp_t* diagonal, int control, int target, int num_qubits) {
+    typedef cpu_lanes<W> L;
+    const int64_t num_states = int64_t(1) << num_qubits;
+
+    #pragma omp parallel for schedule(static) if (num_states >= CPU_PARALLEL_MIN_STATES)
+    for (int64_t i = 0; i < num_states; i += W) {
+        int bit = (i >> target) & 1;
+        int select = (control == -1) ? bit : ((bit << 1) | ((i >> control) & 1));
+        L::store(state + i, L::cmul(diagonal[select], L::load(state + i)));
+    }
+}
+
+// Bit permutation (GATE_PERMUTE). Exchanging disjoint bit pairs is an involution, so it is
+// done in place by swapping each amplitude with its image once.
+inline void cpu_permute(amp_t* state, const amp_t* pairs, int num_pairs, int num_qubits) {
+    const int64_t num_states = int64_t(1) << num_qubits;
+    int64_t mask[GATE_MATRIX_SIZE];
+    int first[GATE_MATRIX_SIZE];
+    int second[GATE_MATRIX_SIZE];
+    for (int p = 0; p < num_pairs; ++p) {
+        first[p] = static_cast<int>(pairs[p].real());
+        second[p] = static_cast<int>(pairs[p].imag());
+        mask[p] = (int64_t(1) << first[p]) | (int64_t(1) << second[p]);
+    }
+
+    #pragma omp parallel for schedule(static) if (num_states >= CPU_PARALLEL_MIN_STATES)
+    for (int64_t i = 0; i < num_states; ++i) {
+        int64_t j = i;
+        for (int p = 0; p < num_pairs; ++p) {
+            if (((i >> first[p]) ^ (i >> second[p])) & 1) {
+                j ^= mask[p];
+            }
+        }
+        if (i < j) {
+            amp_t tmp = state[i];
+            state[i] = state[j];
+            state[j] = tmp;
+        }
+    }
+}
+
+// Function to apply one gate to the state in place, vectorized when its qubits allow it
+template <int W>
+void cpu_apply_gate_width(amp_t* state, const gate_desc& gate, const amp_t* matrix, int num_qubits) {
+    switch (gate.type) {
+    case GATE_SINGLE:
+        cpu_single_qubit<W>(state, matrix, gate.target, num_qubits);
+        break;
+    case GATE_DIAGONAL:
+        cpu_diagonal<W>(state, matrix, gate.control, gate.target, num_qubits);
+        break;
+    case GATE_CX:
+    case GATE_CONTROLLED:
+        cpu_controlled<W>(state, matrix, gate.type == GATE_CX, gate.control, gate.target, num_qubits);
+        break;
+    default:
+        cpu_two_qubit<W>(state, matrix, gate.control, gate.target, num_qubits);
+        break;
+    }
+}
+
+inline void cpu_apply_gate(amp_t* state, const gate_desc& gate, const amp_t* matrix, int num_qubits) {
+    if (gate.type == GATE_PERMUTE) {
+        cpu_permute(state, matrix, gate.control, num_qubits);
+        return;
+    }
+    int lowest = (gate.control == -1 || gate.target < gate.control) ? gate.target : gate.control;
+    if (CPU_SIMD_WIDTH > 1 && lowest >= CPU_SIMD_LOG2) {
+        cpu_apply_gate_width<CPU_SIMD_WIDTH>(state, gate, matrix, num_qubits);
+    } else {
+        cpu_apply_gate_width<1>(state, gate, matrix, num_qubits);
+    }
+}
+
+// Function to apply a GATE_BLOCK in place: each tile of 2^tile_qubits amplitudes is run
+// through all block_size gates while it is resident in cache. Tiles are independent, so
+// they are split across threads; the gates inside a tile run on one thread.
+inline void cpu_apply_block(amp_t* state, const gate_desc* block_gates, int block_size, const amp_t* gate_matrices,
+                            int tile_qubits, int num_qubits) {
+    const int64_t num_tiles = int64_t(1) << (num_qubits - tile_qubits);
+
+    #pragma omp parallel for schedule(static)
+    for (int64_t t = 0; t < num_tiles; ++t) {
+        amp_t* tile = state + (t << tile_qubits);
+        for (int b = 0; b < block_size; ++b) {
+            const gate_desc& gate = block_gates[b];
+            cpu_apply_gate(tile, gate, gate_matrices + gate.matrix * GATE_MATRIX_SIZE, tile_qubits);
+        }
+    }
+}
+
+// Function to set the state to |0...0>, touching the pages from the threads that update them
+inline void cpu_init_state(amp_t* state, int num_qubits) {
+    const int64_t num_states = int64_t(1) << num_qubits;
+
+    #pragma omp parallel for schedule(static) if (num_states >= CPU_PARALLEL_MIN_STATES)
+    for (int64_t i = 0; i < num_states; ++i) {
+        state[i] = make_amp(0.0f, 0.0f);
+    }
+    state[0] = make_amp(1.0f, 0.0f);
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef GATE_BLOCKING_H
+#define GATE_BLOCKING_H
+
+// Host-side grouping of low-qubit gates into GATE_BLOCK records (see gate_desc.h)
+
+#include <vector>
+#include "gate_desc.h"
+
+// True if every qubit of the gate lies inside a tile of 2^tile_qubits amplitudes
+inline bool gate_fits_tile(const gate_desc& gate, int tile_qubits) {
+    return gate.type <= GATE_DIAGONAL && gate.target < tile_qubits && gate.control < tile_qubits;
+}
+
+// Function to group runs of consecutive gates whose qubits all lie below tile_qubits.
+// Each run of two or more gates (split at GATE_BLOCK_MAX_GATES) is preceded by a GATE_BLOCK
+// header, so the run costs one pass over the state instead of one pass per gate. The
+// member records keep their matrix indices, so the matrix pool is shared unchanged.
+// Returns the number of blocks created.
+inline size_t build_gate_blocks(const gate_desc* gates, size_t num_gates, int tile_qubits,
+                                std::vector<gate_desc>& blocked) {
+    size_t num_blocks = 0;
+    blocked.clear();
+    blocked.reserve(num_gates + num_gates / 2);
+
+    size_t i = 0;
+    while (i < num_gates) {
+        size_t run = 0;
+        while (i + run < num_gates && run < GATE_BLOCK_MAX_GATES && gate_fits_tile(gates[i + run], tile_qubits)) {
+            ++run;
+        }
+
+        if (run >= 2) {
+            gate_desc header;
+            header.type = GATE_BLOCK;
+            header.control = static_cast<int>(run);
+            header.target = tile_qubits;
+            header.matrix = 0;
+            blocked.push_back(header);
+            ++num_blocks;
+        } else {
+            run = 1;
+        }
+        blocked.insert(blocked.end(), gates + i, gates + i + run);
+        i += run;
+    }
+    return num_blocks;
+}
+
+// Function to count the passes over the state needed by a gate list (one per plain gate,
+// one per block)
+inline size_t count_state_passes(const gate_desc* gates, size_t num_gates) {
+    size_t passes = 0;
+    for (size_t i = 0; i < num_gates; ++i) {
+        ++passes;
+        if (gates[i].type == GATE_BLOCK) {
+            i += gates[i].control;
+        }
+    }
+    return passes;
+}
+
+#endif
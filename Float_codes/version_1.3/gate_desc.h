@@ -0,0 +1,80 @@
+#ifndef GATE_DESC_H
+#define GATE_DESC_H
+
+// Definitions shared by host.cpp and the vadd kernels
+
+#include "amp_types.h"
+
+// Gate kinds understood by the kernels
+// Two-qubit matrices use the Qiskit ordering of Qasm2CSV.ipynb: the control column is
+// the least significant bit of the 4x4 row/column index, the target column the most.
+enum gate_type {
+    GATE_SINGLE = 0,        // 2x2 matrix applied to the target qubit
+    GATE_CX = 1,            // Controlled-X, applied as amplitude swaps
+    GATE_CONTROLLED = 2,    // 2x2 matrix applied to the target where the control bit is 1
+    GATE_TWO_QUBIT = 3,     // General 4x4 matrix on (control, target)
+    GATE_DIAGONAL = 4,      // Diagonal matrix, applied as one phase per amplitude (in place)
+    GATE_BLOCK = 5,         // Header of a tile block (see below), applied in place
+    GATE_PERMUTE = 6        // Swaps pairs of qubit (bit) positions of the whole state
+};
+
+// GATE_DIAGONAL stores only the diagonal: 2 entries indexed by the target bit for
+// single-qubit gates (control == -1), otherwise 4 entries indexed by the same local
+// index as the 4x4 matrices.
+
+// GATE_BLOCK groups the records that follow it into one pass over the state: the state is
+// cut into tiles of 2^target amplitudes and the next `control` gates, whose qubits all lie
+// below target, are applied to each tile while it is held on chip. The header has no
+// matrix block of its own.
+
+// GATE_PERMUTE exchanges `control` disjoint pairs of bit positions in one pass over the
+// state. Its matrix block holds one pair per entry as exact small floats: entry k is
+// (first position, second position). target is unused and set to 0.
+
+// Largest tile the vadd_circuit kernel holds on chip (2^12 amplitudes, 32 KB of BRAM)
+#define GATE_TILE_MAX_QUBITS 12
+
+// Largest number of gates in one GATE_BLOCK
+#define GATE_BLOCK_MAX_GATES 64
+
+// Number of matrix pool entries reserved per gate (large enough for a 4x4 matrix)
+#define GATE_MATRIX_SIZE 16
+
+// Loop labels and HLS pragmas for kernel code that host.cpp also compiles (state_sampling.h,
+// pauli_expectation.h). They only exist under synthesis, so host builds see neither.
+#ifdef __SYNTHESIS__
+#define HLS_LABEL(name) name:
+#define HLS_PRAGMA(text) _Pragma(#text)
+#else
+#define HLS_LABEL(name)
+#define HLS_PRAGMA(text)
+#endif
+
+// Packed gate descriptor uploaded to the device for vadd_circuit
+struct gate_desc {
+    int type;       // One of gate_type
+    int control;    // Control qubit index (-1 for no control); gate count for GATE_BLOCK,
+                    // pair count for GATE_PERMUTE
+    int target;     // Target qubit index; tile size in qubits for GATE_BLOCK
+    int matrix;     // Index of the gate's GATE_MATRIX_SIZE block in the matrix pool
+};
+
+// Function to count the leading entries of a gate's matrix block that the kernels read:
+// the per-gate host paths upload only these, and the kernels load only these on chip
+inline int gate_matrix_entries(int type, int control) {
+    switch (type) {
+    case GATE_SINGLE:
+    case GATE_CONTROLLED:
+        return 4;
+    case GATE_DIAGONAL:
+        return (control == -1) ? 2 : 4;
+    case GATE_TWO_QUBIT:
+        return GATE_MATRIX_SIZE;
+    case GATE_PERMUTE:
+        return control;
+    default:
+        return 0;  // GATE_CX and GATE_BLOCK have no matrix
+    }
+}
+
+#endif
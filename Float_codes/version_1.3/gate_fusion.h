@@ -0,0 +1,119 @@
+#ifndef GATE_FUSION_H
+#define GATE_FUSION_H
+
+// Host-side single-qubit gate fusion for the packed gate list (see gate_desc.h)
+
+#include <complex>
+#include <vector>
+#include <cmath>
+#include "gate_desc.h"
+#include "gate_list.h"
+
+// 2x2 matrix accumulated in double precision, row-major
+struct fused_matrix {
+    std::complex<double> m[4];
+};
+
+// Returns a * b (apply b first, then a)
+inline fused_matrix multiply_2x2(const fused_matrix& a, const fused_matrix& b) {
+    fused_matrix r;
+    r.m[0] = a.m[0] * b.m[0] + a.m[1] * b.m[2];
+    r.m[1] = a.m[0] * b.m[1] + a.m[1] * b.m[3];
+    r.m[2] = a.m[2] * b.m[0] + a.m[3] * b.m[2];
+    r.m[3] = a.m[2] * b.m[1] + a.m[3] * b.m[3];
+    return r;
+}
+
+// Function to expand the matrix block of a single-qubit gate (GATE_SINGLE or GATE_DIAGONAL)
+inline fused_matrix single_qubit_matrix(const gate_desc& gate, const amp_t* matrix) {
+    fused_matrix m;
+    if (gate.type == GATE_DIAGONAL) {
+        m.m[0] = std::complex<double>(matrix[0].real(), matrix[0].imag());
+        m.m[1] = 0.0;
+        m.m[2] = 0.0;
+        m.m[3] = std::complex<double>(matrix[1].real(), matrix[1].imag());
+    } else {
+        for (int k = 0; k < 4; ++k) {
+            m.m[k] = std::complex<double>(matrix[k].real(), matrix[k].imag());
+        }
+    }
+    return m;
+}
+
+// True if the matrix is the identity (not just up to a global phase)
+inline bool is_identity_2x2(const fused_matrix& a, double tolerance = 1e-7) {
+    return std::abs(a.m[0] - 1.0) < tolerance && std::abs(a.m[1]) < tolerance &&
+           std::abs(a.m[2]) < tolerance && std::abs(a.m[3] - 1.0) < tolerance;
+}
+
+// Function to fuse runs of single-qubit gates on the same target into one 2x2 gate.
+// The fused product is reclassified, so chains of diagonal gates stay diagonal.
+// Pending single-qubit products are kept per qubit and commuted past gates on unrelated
+// qubits; they are only emitted when a multi-qubit gate touches their qubit or at the end
+// of the circuit. Products that reduce to the identity are dropped.
+// Returns the number of gates removed from the list.
+inline size_t fuse_single_qubit_gates(std::vector<gate_desc>& gates, std::vector<amp_t>& gate_matrices, int num_qubits) {
+    std::vector<gate_desc> fused_gates;
+    std::vector<amp_t> fused_matrices;
+    std::vector<fused_matrix> pending(num_qubits);
+    std::vector<bool> has_pending(num_qubits, false);
+
+    fused_gates.reserve(gates.size());
+    fused_matrices.reserve(gate_matrices.size());
+
+    // Append a gate and its matrix block to the fused list
+    auto emit = [&](gate_desc gate, const amp_t* matrix) {
+        gate.matrix = static_cast<int>(fused_gates.size());
+        fused_gates.push_back(gate);
+        fused_matrices.insert(fused_matrices.end(), matrix, matrix + GATE_MATRIX_SIZE);
+    };
+
+    // Emit the pending single-qubit product on qubit q, if any
+    auto flush = [&](int q) {
+        if (q < 0 || !has_pending[q]) {
+            return;
+        }
+        has_pending[q] = false;
+        if (is_identity_2x2(pending[q])) {
+            return;
+        }
+
+        amp_t matrix[GATE_MATRIX_SIZE] = {};
+        for (int k = 0; k < 4; ++k) {
+            matrix[k] = make_amp(static_cast<float>(pending[q].m[k].real()), static_cast<float>(pending[q].m[k].imag()));
+        }
+        gate_desc gate;
+        gate.control = -1;
+        gate.target = q;
+        gate.matrix = 0;
+        classify_gate(gate, matrix);
+        emit(gate, matrix);
+    };
+
+    for (const gate_desc& gate : gates) {
+        const amp_t* matrix = &gate_matrices[gate.matrix * GATE_MATRIX_SIZE];
+
+        if (gate.control == -1) {
+            fused_matrix m = single_qubit_matrix(gate, matrix);
+            pending[gate.target] = has_pending[gate.target] ? multiply_2x2(m, pending[gate.target]) : m;
+            has_pending[gate.target] = true;
+        } else {
+            // Pending products on the qubits of a multi-qubit gate must be applied first
+            flush(gate.control);
+            flush(gate.target);
+            emit(gate, matrix);
+        }
+    }
+
+    // Everything still pending commutes to the end of the circuit
+    for (int q = 0; q < num_qubits; ++q) {
+        flush(q);
+    }
+
+    size_t removed = gates.size() - fused_gates.size();
+    gates.swap(fused_gates);
+    gate_matrices.swap(fused_matrices);
+    return removed;
+}
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef GATE_LIST_H
+#define GATE_LIST_H
+
+// Host-side helpers for building the packed gate list (see gate_desc.h)
+
+#include <complex>
+#include <cmath>
+#include <algorithm>
+#include "gate_desc.h"
+
+// True if two matrix entries are equal within tolerance
+inline bool entry_equals(const amp_t& a, const amp_t& b, float tolerance = 1e-6f) {
+    return std::abs(amp_to_float(a) - amp_to_float(b)) < tolerance;
+}
+
+// True if the 4x4 matrix acts as the identity unless the local bit control_bit (0 or 1)
+// of the row/column index is set, i.e. the matrix is controlled on that bit.
+inline bool is_controlled_4x4(const amp_t* matrix, int control_bit) {
+    for (int row = 0; row < 4; ++row) {
+        for (int col = 0; col < 4; ++col) {
+            bool row_active = (row >> control_bit) & 1;
+            bool col_active = (col >> control_bit) & 1;
+            if (row_active && col_active) {
+                continue;
+            }
+            amp_t expected = (row == col) ? make_amp(1.0f, 0.0f) : make_amp(0.0f, 0.0f);
+            if (!entry_equals(matrix[row * 4 + col], expected)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// True if all off-diagonal entries of the size x size matrix are zero
+inline bool is_diagonal(const amp_t* matrix, int size) {
+    for (int row = 0; row < size; ++row) {
+        for (int col = 0; col < size; ++col) {
+            if (row != col && !entry_equals(matrix[row * size + col], make_amp(0.0f, 0.0f))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Read-only view of a packed gate list, either parsed in memory or mapped from a .q2sv file
+struct gate_list_view {
+    const gate_desc* gates;         // Gate descriptors
+    size_t num_gates;               // Number of descriptors
+    const amp_t* matrices;          // Matrix pool, GATE_MATRIX_SIZE entries per descriptor
+    size_t num_matrix_entries;      // Number of entries in the matrix pool
+    int num_qubits;                 // Number of qubits
+};
+
+// Function to pick the cheapest kernel path for a gate and rewrite its matrix block to match.
+// Diagonal gates (rz, phase, CZ, CPhase, ...) keep only their diagonal. Controlled gates keep
+// only the 2x2 block acting on the target in the first four entries (control and target are
+// swapped if the matrix is controlled on the target column), CX becomes an amplitude swap and
+// anything else runs as a general 4x4 matrix.
+inline void classify_gate(gate_desc& gate, amp_t* matrix) {
+    int size = (gate.control == -1) ? 2 : 4;
+
+    if (is_diagonal(matrix, size)) {
+        amp_t diagonal[4];
+        for (int k = 0; k < size; ++k) {
+            diagonal[k] = matrix[k * size + k];
+        }
+        std::fill(matrix, matrix + GATE_MATRIX_SIZE, make_amp(0.0f, 0.0f));
+        std::copy(diagonal, diagonal + size, matrix);
+        gate.type = GATE_DIAGONAL;
+        return;
+    }
+
+    if (gate.control == -1) {
+        gate.type = GATE_SINGLE;
+        return;
+    }
+
+    for (int control_bit = 0; control_bit < 2; ++control_bit) {
+        if (!is_controlled_4x4(matrix, control_bit)) {
+            continue;
+        }
+
+        // Indices of the active rows/columns for target values 0 and 1
+        int active = 1 << control_bit;
+        int lo = active;
+        int hi = active | (1 << (1 - control_bit));
+        amp_t u[4] = {matrix[lo * 4 + lo], matrix[lo * 4 + hi], matrix[hi * 4 + lo], matrix[hi * 4 + hi]};
+
+        if (control_bit == 1) {
+            std::swap(gate.control, gate.target);
+        }
+        std::fill(matrix, matrix + GATE_MATRIX_SIZE, make_amp(0.0f, 0.0f));
+        std::copy(u, u + 4, matrix);
+
+        bool is_x = entry_equals(u[0], make_amp(0.0f, 0.0f)) && entry_equals(u[1], make_amp(1.0f, 0.0f)) &&
+                    entry_equals(u[2], make_amp(1.0f, 0.0f)) && entry_equals(u[3], make_amp(0.0f, 0.0f));
+        gate.type = is_x ? GATE_CX : GATE_CONTROLLED;
+        return;
+    }
+
+    gate.type = GATE_TWO_QUBIT;
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef GATE_RUN_QUEUE_H
+#define GATE_RUN_QUEUE_H
+
+// Host-side launch queue for the one-gate-per-launch kernels (vadd, vadd_wide, vadd_inplace,
+// vadd_banked). The host does not wait for a gate before launching the next one: runs
+// started on one compute unit execute in submission order, and none of these kernels is a
+// dataflow region, so a queued run starts only after the previous one has written the
+// state. Each gate's matrix is staged in its own slot of a ring of gate buffers, so the
+// upload for gate i+1 goes out while gate i runs and the CU finds its next launch already
+// waiting. A slot is reused only after the run that read it has completed.
+
+#include <xrt/xrt_bo.h>
+#include <xrt/xrt_device.h>
+#include <xrt/xrt_kernel.h>
+#include "gate_desc.h"
+#include "profiler.h"
+
+// Number of gate buffers in the ring (launches in flight at once)
+#define GATE_RING_SIZE 4
+
+// Function to upload the leading entries of a gate's matrix block that the kernels read
+// (gate_matrix_entries). GATE_CX has none, so it costs no transfer at all.
+inline void upload_gate_matrix(xrt::bo& gate_bo, const gate_desc& gate, const amp_t* matrix) {
+    size_t bytes = gate_matrix_entries(gate.type, gate.control) * sizeof(amp_t);
+    if (bytes == 0) {
+        return;
+    }
+    profile_scope scope("gate upload", "transfer", bytes);
+    gate_bo.write(matrix, bytes, 0);
+    gate_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE, bytes, 0);
+}
+
+struct gate_run_queue {
+    xrt::bo gate_bos[GATE_RING_SIZE];   // Ring of gate matrix buffers
+    xrt::run runs[GATE_RING_SIZE];      // Run that reads each slot
+    bool pending[GATE_RING_SIZE];       // True while that run may still be executing
+    size_t next;                        // Launches so far; the next slot is next % GATE_RING_SIZE
+
+    // Allocate the ring in the memory bank of the kernel's gate matrix argument
+    gate_run_queue(const xrt::device& device, int memory_group) : next(0) {
+        for (int s = 0; s < GATE_RING_SIZE; ++s) {
+            gate_bos[s] = xrt::bo(device, GATE_MATRIX_SIZE * sizeof(amp_t), memory_group);
+            pending[s] = false;
+        }
+    }
+
+    // Function to stage a gate's matrix in the next slot and return the buffer to pass to the
+    // kernel. Waits only if that slot's previous run (GATE_RING_SIZE launches back) is still
+    // in flight.
+    xrt::bo& stage(const gate_desc& gate, const amp_t* matrix) {
+        int slot = static_cast<int>(next % GATE_RING_SIZE);
+        if (pending[slot]) {
+            profile_scope scope("run wait", "kernel");
+            runs[slot].wait();
+            pending[slot] = false;
+        }
+        upload_gate_matrix(gate_bos[slot], gate, matrix);
+        return gate_bos[slot];
+    }
+
+    // Function to record the run started with the buffer returned by the last stage()
+    void push(const xrt::run& run) {
+        int slot = static_cast<int>(next % GATE_RING_SIZE);
+        runs[slot] = run;
+        pending[slot] = true;
+        ++next;
+    }
+
+    // Function to wait for every launch in flight (before reading the state back)
+    void drain() {
+        for (size_t k = 0; k < GATE_RING_SIZE; ++k) {
+            // Oldest first, so each wait returns as soon as possible
+            int slot = static_cast<int>((next + k) % GATE_RING_SIZE);
+            if (pending[slot]) {
+                profile_scope scope("run wait", "kernel");
+                runs[slot].wait();
+                pending[slot] = false;
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,1622 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <iomanip>
+#include <complex>
+#include <stdexcept>
+#include <algorithm>
+#include <regex>
+#include <memory>
+#include <chrono>
+#include <cstdlib>
+#ifndef Q2SV_CPU_ONLY
+#include <xrt/xrt_bo.h>
+#include <xrt/xrt_device.h>
+#include <xrt/xrt_kernel.h>
+#include "gate_run_queue.h"
+#endif
+#include "gate_desc.h"
+#include "gate_fusion.h"
+#include "gate_list.h"
+#include "qasm_parser.h"
+#include "circuit_generator.h"
+#include "circuit_file.h"
+#include "state_file.h"
+#include "cpu_backend.h"
+#include "gate_blocking.h"
+#include "qubit_remap.h"
+#include "state_slices.h"
+#include "stream_batches.h"
+#include "state_sampling.h"
+#include "pauli_expectation.h"
+#include "profiler.h"
+
+// Function to parse matrix strings from CSV
+std::vector<std::complex<float>> parse_matrix(const std::string& matrix_str) {
+    std::vector<std::complex<float>> matrix;
+    std::string clean_str = matrix_str;
+
+    // Remove unwanted characters: '[', ']', '(', ')', spaces, and double quotes
+    clean_str.erase(remove(clean_str.begin(), clean_str.end(), '['), clean_str.end());
+    clean_str.erase(remove(clean_str.begin(), clean_str.end(), ']'), clean_str.end());
+    clean_str.erase(remove(clean_str.begin(), clean_str.end(), '('), clean_str.end());
+    clean_str.erase(remove(clean_str.begin(), clean_str.end(), ')'), clean_str.end());
+    clean_str.erase(remove(clean_str.begin(), clean_str.end(), ' '), clean_str.end());
+    clean_str.erase(remove(clean_str.begin(), clean_str.end(), '"'), clean_str.end());
+
+    std::stringstream ss(clean_str);
+    std::string token;
+
+    try {
+        while (std::getline(ss, token, ',')) {
+            float real = 0.0f, imag = 0.0f;
+            size_t j_pos = token.find('j');
+
+            if (j_pos != std::string::npos) {
+                // Handle complex numbers
+                size_t plus_pos = token.find('+');
+                size_t minus_pos = token.find('-', 1); // Look for '-' after the first character
+
+                if (plus_pos != std::string::npos) {
+                    // Format: "a+bi"
+                    real = std::stof(token.substr(0, plus_pos));
+                    imag = std::stof(token.substr(plus_pos + 1, j_pos - plus_pos - 1));
+                } else if (minus_pos != std::string::npos) {
+                    // Format: "a-bi"
+                    real = std::stof(token.substr(0, minus_pos));
+                    imag = std::stof(token.substr(minus_pos, j_pos - minus_pos));
+                } else {
+                    // Purely imaginary (like "bi")
+                    imag = std::stof(token.substr(0, j_pos));
+                }
+            } else {
+                // Handle purely real number
+                real = std::stof(token);
+            }
+
+            matrix.emplace_back(real, imag);
+        }
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Error parsing matrix string: '" << matrix_str << "'\n";
+        std::cerr << "Invalid conversion to complex<float>. Please check the matrix format in the CSV file." << std::endl;
+        throw e;
+    }
+
+    return matrix;
+}
+
+// Function to read gate data from CSV file and number of qubits
+// Each gate becomes a packed descriptor plus a GATE_MATRIX_SIZE block in the matrix pool,
+// which is the layout the vadd_circuit kernel reads from device memory.
+void read_gates(const std::string& filename, std::vector<gate_desc>& gates, std::vector<amp_t>& gate_matrices, int& num_qubits) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file");
+    }
+    
+    std::string line;
+    std::getline(file, line);  // Read the header row containing the number of qubits
+
+    // Extract the number of qubits from the sixth entry in the header row
+    std::stringstream ss(line);
+    std::string value;
+    for (int i = 0; i < 5; ++i) {
+        std::getline(ss, value, ','); // Skip the first five columns
+    }
+    std::getline(ss, value, ','); // The sixth entry should be the number of qubits
+    num_qubits = std::stoi(value); // Convert to integer
+
+    // Now process the gate data rows
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string value;
+        std::vector<std::complex<float>> matrix;
+        std::string matrix_str;
+
+        // Skip unnecessary columns and extract relevant data
+        std::getline(ss, value, ','); // Gate Number (skip)
+        std::getline(ss, value, ','); // Gate Name (skip)
+
+        std::getline(ss, value, ',');
+        int control = (value == "" || value == "NaN") ? -1 : std::stoi(value);  // Handle NaN for single-qubit gate
+
+        std::getline(ss, value, ',');
+        int target = std::stoi(value);  // Target qubit index
+
+        // Read matrix string and parse it
+        std::getline(ss, matrix_str);
+        matrix = parse_matrix(matrix_str);
+        if (matrix.size() > GATE_MATRIX_SIZE) {
+            throw std::runtime_error("Gate matrix larger than 4x4 in row: " + line);
+        }
+
+        gate_desc gate;
+        gate.control = control;
+        gate.target = target;
+        gate.matrix = static_cast<int>(gates.size());
+
+        // Append the matrix to the pool, padded to a full block
+        for (const auto& entry : matrix) {
+            gate_matrices.push_back(make_amp(entry.real(), entry.imag()));
+        }
+        gate_matrices.resize((gates.size() + 1) * GATE_MATRIX_SIZE, make_amp(0.0f, 0.0f));
+
+        // Select the kernel path from the matrix structure
+        classify_gate(gate, &gate_matrices[gate.matrix * GATE_MATRIX_SIZE]);
+        gates.push_back(gate);
+    }
+
+    file.close();
+}
+
+// Pauli string observable of --expect
+struct pauli_observable {
+    std::string label;      // The string as written, qubit n-1 first
+    double coefficient;     // Weight in the reported sum (1 if not given)
+    pauli_term term;        // X/Z masks (pauli_expectation.h)
+};
+
+// Function to read the observables of --expect: one Pauli string per line, optionally
+// preceded by a coefficient ("0.5 XXIZ"), with one I/X/Y/Z per qubit and qubit n-1 first
+// as in Qiskit. Blank lines and lines starting with # are skipped.
+std::vector<pauli_observable> read_observables(const std::string& filename, int num_qubits) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file");
+    }
+    std::vector<pauli_observable> observables;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        ++line_number;
+        std::istringstream fields(line);
+        std::string first, second;
+        if (!(fields >> first) || first[0] == '#') {
+            continue;
+        }
+        pauli_observable observable = {first, 1.0, {0, 0}};
+        if (fields >> second) {
+            try {
+                observable.coefficient = std::stod(first);
+            } catch (const std::exception&) {
+                throw std::runtime_error("line " + std::to_string(line_number) + ": invalid coefficient " + first);
+            }
+            observable.label = second;
+        }
+        if (static_cast<int>(observable.label.size()) != num_qubits) {
+            throw std::runtime_error("line " + std::to_string(line_number) + ": " + observable.label + " is not a string of " +
+                                     std::to_string(num_qubits) + " Paulis");
+        }
+        for (int q = 0; q < num_qubits; ++q) {
+            char pauli = observable.label[num_qubits - 1 - q];
+            if (pauli != 'I' && pauli != 'X' && pauli != 'Y' && pauli != 'Z') {
+                throw std::runtime_error("line " + std::to_string(line_number) + ": unknown Pauli '" + pauli + "'");
+            }
+            if (pauli == 'X' || pauli == 'Y') {
+                observable.term.x_mask |= 1LL << q;
+            }
+            if (pauli == 'Z' || pauli == 'Y') {
+                observable.term.z_mask |= 1LL << q;
+            }
+        }
+        observables.push_back(observable);
+    }
+    if (observables.empty()) {
+        throw std::runtime_error("no Pauli strings");
+    }
+    return observables;
+}
+
+// Execution settings shared by the backends
+struct run_options {
+    std::string binaryFile;     // xclbin to load (FPGA backend)
+    int device_index;           // Alveo device index (FPGA backend)
+    bool circuit_mode;          // One vadd_circuit launch instead of one vadd launch per gate
+    bool banked;                // vadd_banked with the state striped over DDR[0..3]
+    int num_cus;                // vadd compute units sharing the state in per-gate mode
+    bool wide;                  // vadd_wide (512-bit words) instead of vadd in per-gate mode
+    bool in_place;              // vadd_inplace on a single state buffer in per-gate mode
+    int num_chunks;             // Buffers (one per bank) holding the state for vadd_inplace
+    int stream_qubits;          // Out-of-core chunk size in qubits (0: state resident on the device)
+    bool debug_readback;        // Print the state after every gate
+    std::string bench_file;     // Per-gate kernel times as CSV (--bench), empty for none
+    long long num_shots;        // Measurement shots drawn instead of writing the state (0: none)
+    unsigned long long shot_seed;   // Seed of the shots
+    std::vector<pauli_observable> observables;  // Pauli strings of --expect (empty: none)
+    std::string outputMode;     // binary, text or none
+};
+
+// Function to print the state after a gate (--debug-readback)
+void print_state(size_t gate_index, const amp_t* state, int num_qubits) {
+    std::cout << "State after applying gate " << gate_index + 1 << ": ";
+    for (int j = 0; j < (1 << num_qubits); ++j) {
+        std::cout << amp_to_float(state[j]) << " ";
+    }
+    std::cout << "\n";
+}
+
+// Function to write the time of every gate record for --bench (read by Scripts/bench.py)
+int write_bench(const std::string& filename, const gate_list_view& circuit, const std::vector<double>& kernel_us) {
+    std::ofstream bench(filename);
+    if (!bench.is_open()) {
+        std::cerr << "Unable to open " << filename << " for writing.\n";
+        return 1;
+    }
+    bench << "gate,control,target,kernel_us,type\n";
+    size_t record = 0;
+    for (size_t i = 0; i < circuit.num_gates && record < kernel_us.size(); ++i, ++record) {
+        const gate_desc& gate = circuit.gates[i];
+        bench << i << "," << gate.control << "," << gate.target << "," << kernel_us[record] << "," << gate.type << "\n";
+        if (gate.type == GATE_BLOCK) {
+            i += gate.control;  // One time for the whole block
+        }
+    }
+    return 0;
+}
+
+// Function to report the time spent applying the gates
+void print_timing(const char* backend, size_t num_gates, std::chrono::steady_clock::time_point start) {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Applied " << num_gates << " gates on the " << backend << " in " << seconds * 1e3 << " ms";
+    if (seconds > 0) {
+        std::cout << " (" << num_gates / seconds << " gates/s)";
+    }
+    std::cout << "\n";
+}
+
+// Function to write the final state in the selected output mode, from num_chunks buffers
+// in index order
+int write_final_state(const amp_t* const* chunks, int num_chunks, int num_qubits, const std::string& outputMode) {
+    std::string outputFile = (outputMode == "text") ? "final_state_vector.csv" : "final_state_vector.q2st";
+    profile_scope scope("write state", "io", (uint64_t(1) << num_qubits) * sizeof(amp_t));
+    try {
+        if (outputMode == "text") {
+            write_state_text(outputFile, chunks, num_chunks, num_qubits);
+        } else {
+            write_state_binary(outputFile, chunks, num_chunks, num_qubits);
+        }
+        std::cout << "Final state vector written to " << outputFile << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Unable to write the final state: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int write_final_state(const amp_t* state, int num_qubits, const std::string& outputMode) {
+    return write_final_state(&state, 1, num_qubits, outputMode);
+}
+
+// Function to write the outcomes of --shots to shot_counts.csv as "bitstring,count" lines,
+// qubit n-1 first as in Qiskit's counts
+int write_shot_counts(const shot_count* records, long long num_records, int num_qubits, long long num_shots) {
+    const std::string outputFile = "shot_counts.csv";
+    profile_scope scope("write shots", "io", num_records * sizeof(shot_count));
+    std::ofstream counts(outputFile);
+    if (!counts.is_open()) {
+        std::cerr << "Unable to open " << outputFile << " for writing.\n";
+        return 1;
+    }
+    counts << "bitstring,count\n";
+    std::string bits(num_qubits, '0');
+    for (long long r = 0; r < num_records; ++r) {
+        for (int q = 0; q < num_qubits; ++q) {
+            bits[num_qubits - 1 - q] = ((records[r].index >> q) & 1) ? '1' : '0';
+        }
+        counts << bits << "," << records[r].count << "\n";
+    }
+    std::cout << "Sampled " << num_shots << " shots: " << num_records << " distinct outcomes written to " << outputFile << "\n";
+    return 0;
+}
+
+// Function to get the number of outcome records --shots can produce
+size_t max_shot_records(long long num_shots, int num_qubits) {
+    return static_cast<size_t>(std::min<unsigned long long>(num_shots, 1ULL << num_qubits));
+}
+
+// Function to sort the --expect strings by x_mask, the grouping of pauli_expectation.h;
+// order[k] is the observable of sorted term k
+void sort_observables(const std::vector<pauli_observable>& observables, std::vector<pauli_term>& terms, std::vector<size_t>& order) {
+    order.resize(observables.size());
+    for (size_t k = 0; k < order.size(); ++k) {
+        order[k] = k;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return observables[a].term.x_mask < observables[b].term.x_mask;
+    });
+    terms.clear();
+    for (size_t k : order) {
+        terms.push_back(observables[k].term);
+    }
+}
+
+// Function to write the --expect values (given in sorted term order) to expectations.csv
+// and print their weighted sum
+int write_expectations(const std::vector<pauli_observable>& observables, const std::vector<size_t>& order, const double* values) {
+    const std::string outputFile = "expectations.csv";
+    std::vector<double> by_observable(observables.size());
+    for (size_t k = 0; k < order.size(); ++k) {
+        by_observable[order[k]] = values[k];
+    }
+    std::ofstream out(outputFile);
+    if (!out.is_open()) {
+        std::cerr << "Unable to open " << outputFile << " for writing.\n";
+        return 1;
+    }
+    out << "pauli,coefficient,expectation\n" << std::setprecision(12);
+    double sum = 0.0;
+    for (size_t k = 0; k < observables.size(); ++k) {
+        out << observables[k].label << "," << observables[k].coefficient << "," << by_observable[k] << "\n";
+        sum += observables[k].coefficient * by_observable[k];
+    }
+    std::cout << "Evaluated " << observables.size() << " Pauli strings, written to " << outputFile
+              << "; sum of coefficient * expectation: " << std::setprecision(12) << sum << std::setprecision(6) << "\n";
+    return 0;
+}
+
+// Function to evaluate the --expect strings on the host (pauli_expectation.h)
+int expect_final_state(const amp_t* state, int num_qubits, const run_options& options) {
+    std::vector<pauli_term> terms;
+    std::vector<size_t> order;
+    sort_observables(options.observables, terms, order);
+    std::vector<double> values(terms.size());
+    profile_scope scope("pauli expectation", "host");
+    pauli_expectations(state, num_qubits, terms.data(), static_cast<int>(terms.size()), values.data());
+    scope.stop();
+    return write_expectations(options.observables, order, values.data());
+}
+
+// Function to draw the --shots samples on the host (state_sampling.h), for a state that is
+// in host memory anyway: CPU backend, --stream, and the planar vadd buffers
+int sample_final_state(const amp_t* state, int num_qubits, const run_options& options) {
+    profile_scope scope("sample shots", "host");
+    std::vector<double> block_prefix(size_t(1) << (num_qubits - std::min(num_qubits, SAMPLE_BLOCK_LOG2)));
+    std::vector<shot_count> records(max_shot_records(options.num_shots, num_qubits));
+    double total = sample_block_prefix(state, num_qubits, block_prefix.data());
+    long long num_records = sample_shots(state, num_qubits, block_prefix.data(), total, options.num_shots,
+                                         options.shot_seed, records.data());
+    scope.stop();
+    return write_shot_counts(records.data(), num_records, num_qubits, options.num_shots);
+}
+
+// True if the final state is measured (--expect, --shots) instead of written out
+bool measure_requested(const run_options& options) {
+    return !options.observables.empty() || options.num_shots > 0;
+}
+
+// Function to run --expect and --shots on a final state in host memory
+int measure_final_state(const amp_t* state, int num_qubits, const run_options& options) {
+    if (!options.observables.empty() && expect_final_state(state, num_qubits, options) != 0) {
+        return 1;
+    }
+    return (options.num_shots > 0) ? sample_final_state(state, num_qubits, options) : 0;
+}
+
+#ifndef Q2SV_CPU_ONLY
+// Planes of a vadd state buffer (amp_types.h): one amp_t array, or with AMP_LAYOUT_SOA the
+// real plane followed by the imaginary plane. |0...0> has the same bytes in both layouts.
+#ifdef AMP_LAYOUT_SOA
+#define VADD_STATE_PLANES 2
+#else
+#define VADD_STATE_PLANES 1
+#endif
+
+// Function to copy num_states amplitudes of a vadd state buffer to out in amp_t order
+void gather_vadd_state(const amp_t* buffer, amp_t* out, size_t num_states) {
+#ifdef AMP_LAYOUT_SOA
+    const amp_scalar_t* re = reinterpret_cast<const amp_scalar_t*>(buffer);
+    const amp_scalar_t* im = re + num_states;
+    for (size_t i = 0; i < num_states; ++i) {
+        out[i] = amp_t(re[i], im[i]);
+    }
+#else
+    std::copy(buffer, buffer + num_states, out);
+#endif
+}
+
+// Function to sync the first `bytes` of a bo (default: all of it), timed and counted by the
+// profiler
+void sync_bo(xrt::bo& bo, xclBOSyncDirection direction, size_t bytes = 0) {
+    bytes = (bytes == 0) ? bo.size() : bytes;
+    const bool to_device = (direction == XCL_BO_SYNC_BO_TO_DEVICE);
+    profile_scope scope(to_device ? "sync to device" : "sync from device", "transfer", bytes);
+    bo.sync(direction, bytes, 0);
+}
+
+// Function to open the device and load the xclbin, each timed as a profiler phase
+xrt::uuid open_device(const run_options& options, xrt::device& device) {
+    std::cout << "Opening the device " << options.device_index << std::endl;
+    {
+        profile_scope scope("device open", "device");
+        device = xrt::device(options.device_index);
+    }
+    std::cout << "Loading the xclbin " << options.binaryFile << std::endl;
+    profile_scope scope("xclbin load", "device");
+    return device.load_xclbin(options.binaryFile);
+}
+
+// Function to put the chunks of a state left on the device on the four chunk ports of
+// vadd_sample/vadd_expect: num_chunks buffers (1, 2 or 4), chunk j in the bank of port
+// (first_port + j) % 4 (DDR[port], see u200.cfg). Ports without a chunk get a placeholder in
+// their own bank.
+void bind_state_ports(const xrt::device& device, const xrt::kernel& kernel, const xrt::bo* chunks, int num_chunks,
+                      int first_port, xrt::bo ports[4]) {
+    for (int j = 0; j < num_chunks; ++j) {
+        ports[(first_port + j) & 3] = chunks[j];
+    }
+    for (int port = 0; port < 4; ++port) {
+        if (!ports[port]) {
+            ports[port] = xrt::bo(device, sizeof(amp_t), kernel.group_id(port));
+        }
+    }
+}
+
+// Function to evaluate the --expect strings with vadd_expect on a state left on the device
+// (chunks as for bind_state_ports); only one double per string is read back
+int expect_on_device(const xrt::device& device, const xrt::uuid& uuid, const xrt::bo* chunks, int num_chunks,
+                     int first_port, int num_qubits, const run_options& options) {
+    auto kernel = xrt::kernel(device, uuid, "vadd_expect", xrt::kernel::cu_access_mode::exclusive);
+    const int chunk_bits = (num_chunks == 4) ? 2 : num_chunks - 1;
+    std::vector<pauli_term> terms;
+    std::vector<size_t> order;
+    sort_observables(options.observables, terms, order);
+
+    profile_scope alloc_scope("bo alloc", "device");
+    xrt::bo ports[4];
+    bind_state_ports(device, kernel, chunks, num_chunks, first_port, ports);
+    xrt::bo terms_bo = xrt::bo(device, terms.size() * sizeof(pauli_term), kernel.group_id(4));
+    xrt::bo values_bo = xrt::bo(device, terms.size() * sizeof(double), kernel.group_id(5));
+    alloc_scope.stop();
+    terms_bo.write(terms.data());
+    sync_bo(terms_bo, XCL_BO_SYNC_BO_TO_DEVICE);
+
+    auto start = std::chrono::steady_clock::now();
+    auto run = kernel(ports[0], ports[1], ports[2], ports[3], terms_bo, values_bo, static_cast<int>(terms.size()),
+                      num_qubits, chunk_bits, first_port);
+    {
+        profile_scope scope("run wait", "kernel");
+        run.wait();
+    }
+    sync_bo(values_bo, XCL_BO_SYNC_BO_FROM_DEVICE);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Evaluated on the FPGA in " << ms << " ms\n";
+    return write_expectations(options.observables, order, values_bo.map<double*>());
+}
+
+// Function to draw the --shots samples with vadd_sample from a state left on the device
+// (chunks as for bind_state_ports), so only the outcome records are read back
+int sample_on_device(const xrt::device& device, const xrt::uuid& uuid, const xrt::bo* chunks, int num_chunks,
+                     int first_port, int num_qubits, const run_options& options) {
+    auto kernel = xrt::kernel(device, uuid, "vadd_sample", xrt::kernel::cu_access_mode::exclusive);
+    const int chunk_bits = (num_chunks == 4) ? 2 : num_chunks - 1;
+    const size_t num_blocks = size_t(1) << (num_qubits - std::min(num_qubits, SAMPLE_BLOCK_LOG2));
+    const size_t max_records = max_shot_records(options.num_shots, num_qubits);
+
+    profile_scope alloc_scope("bo alloc", "device");
+    xrt::bo ports[4];
+    bind_state_ports(device, kernel, chunks, num_chunks, first_port, ports);
+    xrt::bo prefix_bo = xrt::bo(device, num_blocks * sizeof(double), kernel.group_id(4));
+    xrt::bo results_bo = xrt::bo(device, (max_records + 1) * sizeof(shot_count), kernel.group_id(5));
+    alloc_scope.stop();
+
+    auto start = std::chrono::steady_clock::now();
+    auto run = kernel(ports[0], ports[1], ports[2], ports[3], prefix_bo, results_bo, num_qubits, chunk_bits,
+                      first_port, options.num_shots, options.shot_seed);
+    {
+        profile_scope scope("run wait", "kernel");
+        run.wait();
+    }
+
+    // Record 0 holds the number of outcomes; read back only those
+    sync_bo(results_bo, XCL_BO_SYNC_BO_FROM_DEVICE, sizeof(shot_count));
+    const shot_count* results = results_bo.map<shot_count*>();
+    long long num_records = results[0].index;
+    sync_bo(results_bo, XCL_BO_SYNC_BO_FROM_DEVICE, (num_records + 1) * sizeof(shot_count));
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Sampled on the FPGA in " << ms << " ms\n";
+    return write_shot_counts(results + 1, num_records, num_qubits, options.num_shots);
+}
+
+// Function to run --expect and --shots on a state left on the device
+int measure_on_device(const xrt::device& device, const xrt::uuid& uuid, const xrt::bo* chunks, int num_chunks,
+                      int first_port, int num_qubits, const run_options& options) {
+    if (!options.observables.empty() &&
+        expect_on_device(device, uuid, chunks, num_chunks, first_port, num_qubits, options) != 0) {
+        return 1;
+    }
+    return (options.num_shots > 0) ? sample_on_device(device, uuid, chunks, num_chunks, first_port, num_qubits, options) : 0;
+}
+
+// Function to run the gate list on the FPGA and write the final state
+int run_fpga(const gate_list_view& circuit, const run_options& options) {
+    const gate_desc* gate_list = circuit.gates;
+    size_t num_gates = circuit.num_gates;
+    const amp_t* matrix_pool = circuit.matrices;
+    int num_qubits = circuit.num_qubits;
+
+    // Load device and xclbin
+    xrt::device device;
+    auto uuid = open_device(options, device);
+
+    // Initialize state vector based on the number of qubits
+    int state_vector_size = 1 << num_qubits;
+    size_t state_bytes = state_vector_size * sizeof(amp_t);
+
+    // Ping-pong buffers: a gate reads state_bos[src] and writes state_bos[1 - src], and the
+    // roles swap after every gate so the state stays resident on the device and only
+    // crosses PCIe once at load and once at readback.
+    xrt::bo state_bos[2];
+    int src = 0;
+
+    if (options.circuit_mode) {
+        // Set up kernel
+        auto kernel = xrt::kernel(device, uuid, "vadd_circuit", xrt::kernel::cu_access_mode::exclusive);
+
+        // Allocate buffers on the device
+        profile_scope alloc_scope("bo alloc", "device");
+        state_bos[0] = xrt::bo(device, state_bytes, kernel.group_id(0));
+        state_bos[1] = xrt::bo(device, state_bytes, kernel.group_id(1));
+        xrt::bo gate_list_bo = xrt::bo(device, num_gates * sizeof(gate_desc), kernel.group_id(2));
+        xrt::bo gate_pool_bo = xrt::bo(device, circuit.num_matrix_entries * sizeof(amp_t), kernel.group_id(3));
+        alloc_scope.stop();
+
+        // Copy initial state and the gate list to the device
+        auto state_map = state_bos[0].map<amp_t*>();
+        std::fill(state_map, state_map + state_vector_size, make_amp(0.0f, 0.0f));
+        state_map[0] = make_amp(1.0f, 0.0f);  // Initialize to |0000>
+        gate_list_bo.write(gate_list);
+        gate_pool_bo.write(matrix_pool);
+        sync_bo(state_bos[0], XCL_BO_SYNC_BO_TO_DEVICE);
+        sync_bo(gate_list_bo, XCL_BO_SYNC_BO_TO_DEVICE);
+        sync_bo(gate_pool_bo, XCL_BO_SYNC_BO_TO_DEVICE);
+
+        // Run the whole circuit in one launch
+        auto start = std::chrono::steady_clock::now();
+        auto run = kernel(state_bos[0], state_bos[1], gate_list_bo, gate_pool_bo, static_cast<int>(num_gates), num_qubits);
+        {
+            profile_scope scope("run wait", "kernel");
+            run.wait();
+        }
+        print_timing("FPGA", num_gates, start);
+
+        // Every gate except the in-place diagonal ones and tile blocks swaps the buffers
+        for (size_t i = 0; i < num_gates; ++i) {
+            if (gate_list[i].type == GATE_BLOCK) {
+                i += gate_list[i].control;
+            } else if (gate_list[i].type != GATE_DIAGONAL) {
+                src = 1 - src;
+            }
+        }
+    } else {
+        // Set up kernel. vadd_wide takes the same arguments and buffers as vadd.
+        const char* kernel_name = options.wide ? "vadd_wide" : "vadd:{vadd_1}";
+        auto kernel = xrt::kernel(device, uuid, kernel_name, xrt::kernel::cu_access_mode::exclusive);
+
+        // Allocate buffers on the device
+        // Both state buffers live in the same bank since they swap input/output roles between gates
+        profile_scope alloc_scope("bo alloc", "device");
+        state_bos[0] = xrt::bo(device, state_bytes, kernel.group_id(0));
+        state_bos[1] = xrt::bo(device, state_bytes, kernel.group_id(0));
+        gate_run_queue queue(device, kernel.group_id(1));  // Ring of gate buffers
+        alloc_scope.stop();
+
+        // Copy initial state to the device
+        auto state_map = state_bos[0].map<amp_t*>();
+        std::fill(state_map, state_map + state_vector_size, make_amp(0.0f, 0.0f));
+        state_map[0] = make_amp(1.0f, 0.0f);  // Initialize to |0000>
+        sync_bo(state_bos[0], XCL_BO_SYNC_BO_TO_DEVICE);
+
+        // Apply gates in order. Launches are queued without waiting (gate_run_queue.h),
+        // except with --bench, which times every gate from upload to completion.
+        std::vector<double> kernel_us;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < num_gates; ++i) {
+            const gate_desc& gate = gate_list[i];
+            auto gate_start = std::chrono::steady_clock::now();
+
+            // Prepare gate data
+            xrt::bo& gate_bo = queue.stage(gate, matrix_pool + gate.matrix * GATE_MATRIX_SIZE);
+
+            // Run kernel. Diagonal gates update the current buffer in place.
+            bool in_place = (gate.type == GATE_DIAGONAL);
+            int dst = in_place ? src : 1 - src;
+            profile_scope launch_scope(profile_gate_name(gate.type), "launch");
+            queue.push(kernel(state_bos[src], gate_bo, state_bos[dst], gate.type, gate.control, gate.target, num_qubits));
+            launch_scope.stop();
+            if (!options.bench_file.empty()) {
+                queue.drain();
+                kernel_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - gate_start).count());
+            }
+
+            // Swap input and output roles for the next gate
+            src = dst;
+
+            // Debug: Read back and print the state after each gate application
+            if (options.debug_readback) {
+                queue.drain();
+                sync_bo(state_bos[src], XCL_BO_SYNC_BO_FROM_DEVICE);
+                std::vector<amp_t> host_state(state_vector_size);
+                gather_vadd_state(state_bos[src].map<amp_t*>(), host_state.data(), state_vector_size);
+                print_state(i, host_state.data(), num_qubits);
+            }
+        }
+        queue.drain();
+        print_timing("FPGA", num_gates, start);
+        if (!options.bench_file.empty() && write_bench(options.bench_file, circuit, kernel_us) != 0) {
+            return 1;
+        }
+    }
+
+    if (measure_requested(options)) {
+#ifdef AMP_LAYOUT_SOA
+        if (!options.circuit_mode && !options.wide) {
+            // vadd_sample and vadd_expect read amp_t buffers; planar ones are measured on the host
+            sync_bo(state_bos[src], XCL_BO_SYNC_BO_FROM_DEVICE);
+            std::vector<amp_t> host_state(state_vector_size);
+            gather_vadd_state(state_bos[src].map<amp_t*>(), host_state.data(), state_vector_size);
+            return measure_final_state(host_state.data(), num_qubits, options);
+        }
+#endif
+        // vadd_1 uses DDR[0], vadd_wide DDR[1], vadd_circuit state_a DDR[0] and state_b DDR[2]
+        int port = options.circuit_mode ? 2 * src : (options.wide ? 1 : 0);
+        return measure_on_device(device, uuid, &state_bos[src], 1, port, num_qubits, options);
+    }
+    if (options.outputMode == "none") {
+        return 0;
+    }
+
+    // Synchronize back the final state vector and write it straight from the mapped buffer
+    sync_bo(state_bos[src], XCL_BO_SYNC_BO_FROM_DEVICE);
+#ifdef AMP_LAYOUT_SOA
+    if (!options.circuit_mode && !options.wide) {
+        // Planar vadd buffers are gathered into amp_t order first
+        std::vector<amp_t> host_state(state_vector_size);
+        gather_vadd_state(state_bos[src].map<amp_t*>(), host_state.data(), state_vector_size);
+        return write_final_state(host_state.data(), num_qubits, options.outputMode);
+    }
+#endif
+    return write_final_state(state_bos[src].map<amp_t*>(), num_qubits, options.outputMode);
+}
+
+// Function to run the gate list on vadd_inplace, which updates the state in place: one
+// buffer per chunk (options.num_chunks of them, chunk j in DDR[j]) and no ping-pong copy.
+// Sizes are 64-bit, so this path runs up to 32 qubits in complex<float> across four banks.
+int run_fpga_in_place(const gate_list_view& circuit, const run_options& options) {
+    const int num_qubits = circuit.num_qubits;
+    int chunk_bits = 0;
+    while ((1 << chunk_bits) < options.num_chunks) {
+        ++chunk_bits;
+    }
+    if (num_qubits - chunk_bits < 1) {
+        std::cerr << "--chunks " << options.num_chunks << " needs at least " << chunk_bits + 1 << " qubits\n";
+        return 1;
+    }
+
+    // Load device and xclbin
+    xrt::device device;
+    auto uuid = open_device(options, device);
+
+    auto kernel = xrt::kernel(device, uuid, "vadd_inplace", xrt::kernel::cu_access_mode::exclusive);
+
+    // Chunk buffers in the banks of chunk0..chunk3; ports without a chunk get a placeholder
+    // in their own bank so every argument matches its connectivity
+    const size_t chunk_states = size_t(1) << (num_qubits - chunk_bits);
+    profile_scope alloc_scope("bo alloc", "device");
+    xrt::bo chunk_bos[4];
+    for (int j = 0; j < 4; ++j) {
+        size_t bytes = (j < options.num_chunks) ? chunk_states * sizeof(amp_t) : sizeof(amp_t);
+        chunk_bos[j] = xrt::bo(device, bytes, kernel.group_id(j));
+    }
+    gate_run_queue queue(device, kernel.group_id(4));
+    alloc_scope.stop();
+
+    // Copy initial state to the device
+    std::vector<const amp_t*> chunk_maps;
+    for (int j = 0; j < options.num_chunks; ++j) {
+        auto state_map = chunk_bos[j].map<amp_t*>();
+        std::fill(state_map, state_map + chunk_states, make_amp(0.0f, 0.0f));
+        if (j == 0) {
+            state_map[0] = make_amp(1.0f, 0.0f);  // Initialize to |0000>
+        }
+        sync_bo(chunk_bos[j], XCL_BO_SYNC_BO_TO_DEVICE);
+        chunk_maps.push_back(state_map);
+    }
+
+    auto read_state = [&]() {
+        for (int j = 0; j < options.num_chunks; ++j) {
+            sync_bo(chunk_bos[j], XCL_BO_SYNC_BO_FROM_DEVICE);
+        }
+    };
+
+    // Apply gates in order, queued without waiting (gate_run_queue.h) unless --bench times them
+    std::vector<double> kernel_us;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < circuit.num_gates; ++i) {
+        const gate_desc& gate = circuit.gates[i];
+        auto gate_start = std::chrono::steady_clock::now();
+
+        xrt::bo& gate_bo = queue.stage(gate, circuit.matrices + gate.matrix * GATE_MATRIX_SIZE);
+        profile_scope launch_scope(profile_gate_name(gate.type), "launch");
+        queue.push(kernel(chunk_bos[0], chunk_bos[1], chunk_bos[2], chunk_bos[3], gate_bo,
+                          gate.type, gate.control, gate.target, num_qubits, chunk_bits));
+        launch_scope.stop();
+        if (!options.bench_file.empty()) {
+            queue.drain();
+            kernel_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - gate_start).count());
+        }
+
+        if (options.debug_readback) {
+            queue.drain();
+            read_state();
+            std::vector<amp_t> host_state;
+            for (int j = 0; j < options.num_chunks; ++j) {
+                host_state.insert(host_state.end(), chunk_maps[j], chunk_maps[j] + chunk_states);
+            }
+            print_state(i, host_state.data(), num_qubits);
+        }
+    }
+    queue.drain();
+    print_timing("FPGA", circuit.num_gates, start);
+    if (!options.bench_file.empty() && write_bench(options.bench_file, circuit, kernel_us) != 0) {
+        return 1;
+    }
+
+    if (measure_requested(options)) {
+        return measure_on_device(device, uuid, chunk_bos, options.num_chunks, 0, num_qubits, options);
+    }
+    if (options.outputMode == "none") {
+        return 0;
+    }
+
+    // Write the chunks straight from the mapped buffers
+    read_state();
+    return write_final_state(chunk_maps.data(), options.num_chunks, num_qubits, options.outputMode);
+}
+
+// Function to run the gate list out of core (stream_batches.h): the state stays in host
+// memory and vadd_circuit applies each batch of gates to one device chunk at a time. Three
+// chunk slots rotate so that while chunk i computes, chunk i + 1 uploads and chunk i - 1
+// downloads with asynchronous bo syncs.
+int run_fpga_stream(const gate_list_view& circuit, const run_options& options) {
+    const int num_qubits = circuit.num_qubits;
+    const int chunk_qubits = std::min(options.stream_qubits, num_qubits);
+    const size_t num_states = size_t(1) << num_qubits;
+    const size_t chunk_states = size_t(1) << chunk_qubits;
+    const size_t chunk_bytes = chunk_states * sizeof(amp_t);
+
+    size_t state_bytes = (num_states * sizeof(amp_t) + 63) & ~size_t(63);
+    std::unique_ptr<amp_t, decltype(&std::free)> state(static_cast<amp_t*>(std::aligned_alloc(64, state_bytes)), &std::free);
+    if (!state) {
+        std::cerr << "Unable to allocate " << state_bytes << " bytes of host memory for the state vector\n";
+        return 1;
+    }
+    cpu_init_state(state.get(), num_qubits);
+
+    std::vector<stream_batch> batches = plan_stream_batches(circuit.gates, circuit.num_gates, num_qubits, chunk_qubits);
+    const size_t num_chunks = num_states / chunk_states;
+    std::cout << "Streaming " << num_chunks << " chunks of " << chunk_qubits << " qubits through " << batches.size()
+              << " batches\n";
+
+    // Load device and xclbin
+    xrt::device device;
+    auto uuid = open_device(options, device);
+
+    auto kernel = xrt::kernel(device, uuid, "vadd_circuit", xrt::kernel::cu_access_mode::exclusive);
+
+    // Three chunk slots, each a vadd_circuit ping-pong pair; the pool is uploaded once and
+    // the gate records of each batch (mapped to chunk positions) before its chunks
+    const int num_slots = 3;
+    profile_scope alloc_scope("bo alloc", "device");
+    xrt::bo slot_a[num_slots];
+    xrt::bo slot_b[num_slots];
+    for (int k = 0; k < num_slots; ++k) {
+        slot_a[k] = xrt::bo(device, chunk_bytes, kernel.group_id(0));
+        slot_b[k] = xrt::bo(device, chunk_bytes, kernel.group_id(1));
+    }
+    xrt::bo gate_list_bo = xrt::bo(device, std::max<size_t>(circuit.num_gates, 1) * sizeof(gate_desc), kernel.group_id(2));
+    xrt::bo gate_pool_bo = xrt::bo(device, circuit.num_matrix_entries * sizeof(amp_t), kernel.group_id(3));
+    alloc_scope.stop();
+    gate_pool_bo.write(circuit.matrices);
+    sync_bo(gate_pool_bo, XCL_BO_SYNC_BO_TO_DEVICE);
+
+    auto start = std::chrono::steady_clock::now();
+    for (const stream_batch& batch : batches) {
+        std::vector<gate_desc> mapped;
+        bool result_in_b = false;
+        for (size_t g = 0; g < batch.count; ++g) {
+            mapped.push_back(stream_map_gate(circuit.gates[batch.first + g], batch));
+            if (mapped.back().type != GATE_DIAGONAL) {
+                result_in_b = !result_in_b;
+            }
+        }
+        gate_list_bo.write(mapped.data(), mapped.size() * sizeof(gate_desc), 0);
+        sync_bo(gate_list_bo, XCL_BO_SYNC_BO_TO_DEVICE, mapped.size() * sizeof(gate_desc));
+
+        const size_t run_states = size_t(1) << batch.local_qubits;
+        const size_t num_runs = chunk_states / run_states;
+
+        // Gather chunk j from its runs into a slot, and scatter it back
+        auto gather = [&](size_t j, amp_t* slot) {
+            profile_scope scope("stream gather", "host", chunk_bytes);
+            for (size_t r = 0; r < num_runs; ++r) {
+                std::copy(state.get() + stream_run_base(batch, j, r), state.get() + stream_run_base(batch, j, r) + run_states,
+                          slot + r * run_states);
+            }
+        };
+        auto scatter = [&](size_t j, const amp_t* slot) {
+            profile_scope scope("stream scatter", "host", chunk_bytes);
+            for (size_t r = 0; r < num_runs; ++r) {
+                std::copy(slot + r * run_states, slot + (r + 1) * run_states, state.get() + stream_run_base(batch, j, r));
+            }
+        };
+
+        // Step i: start chunk i - 1 as soon as chunk i - 2 is done, download chunk i - 2,
+        // scatter chunk i - 3, then gather and upload chunk i into the slot it freed
+        std::vector<xrt::bo::async_handle> uploads(num_chunks);
+        std::vector<xrt::bo::async_handle> downloads(num_chunks);
+        std::vector<xrt::run> runs(num_chunks);
+        for (size_t i = 0; i < num_chunks + 3; ++i) {
+            if (i >= 2 && i - 2 < num_chunks) {
+                profile_scope scope("run wait", "kernel");
+                runs[i - 2].wait();
+            }
+            if (i >= 1 && i - 1 < num_chunks) {
+                int slot = (i - 1) % num_slots;
+                {
+                    profile_scope scope("upload wait", "transfer", chunk_bytes);
+                    uploads[i - 1].wait();
+                }
+                runs[i - 1] = kernel(slot_a[slot], slot_b[slot], gate_list_bo, gate_pool_bo,
+                                     static_cast<int>(batch.count), chunk_qubits);
+            }
+            if (i >= 2 && i - 2 < num_chunks) {
+                int slot = (i - 2) % num_slots;
+                xrt::bo& result = result_in_b ? slot_b[slot] : slot_a[slot];
+                downloads[i - 2] = result.async(XCL_BO_SYNC_BO_FROM_DEVICE, chunk_bytes, 0);
+            }
+            if (i >= 3 && i - 3 < num_chunks) {
+                int slot = (i - 3) % num_slots;
+                xrt::bo& result = result_in_b ? slot_b[slot] : slot_a[slot];
+                {
+                    profile_scope scope("download wait", "transfer", chunk_bytes);
+                    downloads[i - 3].wait();
+                }
+                scatter(i - 3, result.map<amp_t*>());
+            }
+            if (i < num_chunks) {
+                int slot = i % num_slots;
+                gather(i, slot_a[slot].map<amp_t*>());
+                uploads[i] = slot_a[slot].async(XCL_BO_SYNC_BO_TO_DEVICE, chunk_bytes, 0);
+            }
+        }
+
+        if (options.debug_readback) {
+            print_state(batch.first + batch.count - 1, state.get(), num_qubits);
+        }
+    }
+    print_timing("FPGA", circuit.num_gates, start);
+
+    if (measure_requested(options)) {
+        return measure_final_state(state.get(), num_qubits, options);
+    }
+    if (options.outputMode == "none") {
+        return 0;
+    }
+    return write_final_state(state.get(), num_qubits, options.outputMode);
+}
+
+// Function to run the gate list on vadd_banked, with the state striped over the four DDR
+// banks: quarter k (top two index bits equal to k) lives in DDR[k] and every quarter has a
+// ping-pong pair of buffers in its own bank.
+int run_fpga_banked(const gate_list_view& circuit, const run_options& options) {
+    const int num_qubits = circuit.num_qubits;
+    if (num_qubits < 3) {
+        std::cerr << "--banked needs at least 3 qubits\n";
+        return 1;
+    }
+
+    // Load device and xclbin
+    xrt::device device;
+    auto uuid = open_device(options, device);
+
+    auto kernel = xrt::kernel(device, uuid, "vadd_banked", xrt::kernel::cu_access_mode::exclusive);
+
+    const size_t quarter_states = size_t(1) << (num_qubits - 2);
+    const size_t quarter_bytes = quarter_states * sizeof(amp_t);
+
+    // state_bos[copy][k]: quarter k of ping-pong copy 0 or 1, allocated in the bank of in<k>
+    profile_scope alloc_scope("bo alloc", "device");
+    xrt::bo state_bos[2][4];
+    for (int copy = 0; copy < 2; ++copy) {
+        for (int k = 0; k < 4; ++k) {
+            state_bos[copy][k] = xrt::bo(device, quarter_bytes, kernel.group_id(k));
+        }
+    }
+    gate_run_queue queue(device, kernel.group_id(8));
+    alloc_scope.stop();
+
+    // Copy initial state to the device
+    for (int k = 0; k < 4; ++k) {
+        auto state_map = state_bos[0][k].map<amp_t*>();
+        std::fill(state_map, state_map + quarter_states, make_amp(0.0f, 0.0f));
+        if (k == 0) {
+            state_map[0] = make_amp(1.0f, 0.0f);  // Initialize to |0000>
+        }
+        sync_bo(state_bos[0][k], XCL_BO_SYNC_BO_TO_DEVICE);
+    }
+
+    std::vector<amp_t> host_state;
+    auto read_state = [&](int copy) {
+        host_state.resize(quarter_states * 4);
+        for (int k = 0; k < 4; ++k) {
+            sync_bo(state_bos[copy][k], XCL_BO_SYNC_BO_FROM_DEVICE);
+            state_bos[copy][k].read(host_state.data() + k * quarter_states);
+        }
+    };
+
+    // Apply gates in order, queued without waiting (gate_run_queue.h) unless --bench times them
+    int src = 0;
+    std::vector<double> kernel_us;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < circuit.num_gates; ++i) {
+        const gate_desc& gate = circuit.gates[i];
+        auto gate_start = std::chrono::steady_clock::now();
+
+        // Prepare gate data
+        xrt::bo& gate_bo = queue.stage(gate, circuit.matrices + gate.matrix * GATE_MATRIX_SIZE);
+
+        // Run kernel. Diagonal gates update the current buffers in place.
+        int dst = (gate.type == GATE_DIAGONAL) ? src : 1 - src;
+        profile_scope launch_scope(profile_gate_name(gate.type), "launch");
+        queue.push(kernel(state_bos[src][0], state_bos[src][1], state_bos[src][2], state_bos[src][3],
+                          state_bos[dst][0], state_bos[dst][1], state_bos[dst][2], state_bos[dst][3],
+                          gate_bo, gate.type, gate.control, gate.target, num_qubits));
+        launch_scope.stop();
+        src = dst;
+        if (!options.bench_file.empty()) {
+            queue.drain();
+            kernel_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - gate_start).count());
+        }
+
+        if (options.debug_readback) {
+            queue.drain();
+            read_state(src);
+            print_state(i, host_state.data(), num_qubits);
+        }
+    }
+    queue.drain();
+    print_timing("FPGA", circuit.num_gates, start);
+    if (!options.bench_file.empty() && write_bench(options.bench_file, circuit, kernel_us) != 0) {
+        return 1;
+    }
+
+    if (measure_requested(options)) {
+        // Quarter k is chunk k in DDR[k]
+        return measure_on_device(device, uuid, state_bos[src], 4, 0, num_qubits, options);
+    }
+    if (options.outputMode == "none") {
+        return 0;
+    }
+
+    // Gather the four quarters and write the final state
+    read_state(src);
+    return write_final_state(host_state.data(), num_qubits, options.outputMode);
+}
+
+// Function to run the gate list on options.num_cus vadd compute units (vadd_1..vadd_N, one
+// per DDR bank), each holding one slice of the state in its own bank (state_slices.h).
+// Gates that reduce to slice-local gates are queued on every CU without waiting on any.
+// A gate that needs a global qubit in a local position first exchanges that global position
+// with a free local one by swapping half-slices between partner slices with bo.copy; the
+// host tracks the resulting qubit layout and restores it before the readback.
+int run_fpga_multi_cu(const gate_list_view& circuit, const run_options& options) {
+    const int num_qubits = circuit.num_qubits;
+    const int num_cus = options.num_cus;
+    int slice_bits = 0;
+    while ((1 << slice_bits) < num_cus) {
+        ++slice_bits;
+    }
+    const int local_qubits = num_qubits - slice_bits;
+    if (local_qubits < 2) {
+        std::cerr << "--cus " << num_cus << " needs at least " << slice_bits + 2 << " qubits\n";
+        return 1;
+    }
+
+    // Load device and xclbin
+    xrt::device device;
+    auto uuid = open_device(options, device);
+
+    const size_t slice_states = size_t(1) << local_qubits;
+    const size_t slice_bytes = slice_states * sizeof(amp_t);
+
+    // Per CU: a kernel handle bound to that CU, a ping-pong pair of slice buffers and a ring
+    // of gate buffers, all in the CU's bank. Slices skip gates independently, so each has its
+    // own src. Each CU queues its launches (gate_run_queue.h); the queues are drained only
+    // before an exchange or a readback touches the slices.
+    std::vector<xrt::kernel> kernels;
+    xrt::bo state_bos[2][SLICE_MAX_CUS];
+    std::vector<gate_run_queue> queues;
+    int src[SLICE_MAX_CUS];
+    for (int k = 0; k < num_cus; ++k) {
+        std::string cu_name = "vadd:{vadd_" + std::to_string(k + 1) + "}";
+        kernels.push_back(xrt::kernel(device, uuid, cu_name, xrt::kernel::cu_access_mode::exclusive));
+        profile_scope alloc_scope("bo alloc", "device");
+        state_bos[0][k] = xrt::bo(device, slice_bytes, kernels[k].group_id(0));
+        state_bos[1][k] = xrt::bo(device, slice_bytes, kernels[k].group_id(0));
+        queues.emplace_back(device, kernels[k].group_id(1));
+        alloc_scope.stop();
+
+        // Copy initial state to the device
+        auto state_map = state_bos[0][k].map<amp_t*>();
+        std::fill(state_map, state_map + slice_states, make_amp(0.0f, 0.0f));
+        if (k == 0) {
+            state_map[0] = make_amp(1.0f, 0.0f);  // Initialize to |0000>
+        }
+        sync_bo(state_bos[0][k], XCL_BO_SYNC_BO_TO_DEVICE);
+        src[k] = 0;
+    }
+
+    // Qubit layout: physical[q] is the bit position of logical qubit q, holder the inverse
+    std::vector<int> physical(num_qubits);
+    std::vector<int> holder(num_qubits);
+    for (int q = 0; q < num_qubits; ++q) {
+        physical[q] = q;
+        holder[q] = q;
+    }
+
+    // Exchange the qubits at global position g and local position l. Amplitudes with bit l
+    // set in slice k (bit g clear) trade places with those with bit l clear in the partner
+    // slice k | bit, one 2^l amplitude block at a time (in each plane of a planar buffer, as
+    // the block pairs tile both planes alike). The current buffers are updated in place, with
+    // the idle ping-pong buffer of slice k as scratch.
+    size_t num_exchanges = 0;
+    auto drain = [&]() {
+        for (auto& queue : queues) {
+            queue.drain();
+        }
+    };
+    auto exchange = [&](int g, int l) {
+        drain();
+        profile_scope scope("slice exchange", "transfer");
+        const int bit = 1 << (g - local_qubits);
+        const size_t block_bytes = (size_t(1) << l) * (sizeof(amp_t) / VADD_STATE_PLANES);
+        for (int k = 0; k < num_cus; ++k) {
+            if (k & bit) {
+                continue;
+            }
+            int partner = k | bit;
+            xrt::bo& mine = state_bos[src[k]][k];
+            xrt::bo& scratch = state_bos[1 - src[k]][k];
+            xrt::bo& theirs = state_bos[src[partner]][partner];
+            for (size_t low = 0; low < slice_bytes; low += 2 * block_bytes) {
+                size_t high = low + block_bytes;
+                scratch.copy(mine, block_bytes, high, high);
+                mine.copy(theirs, block_bytes, low, high);
+                theirs.copy(scratch, block_bytes, high, low);
+                scope.add_bytes(3 * block_bytes);
+            }
+        }
+        std::swap(holder[g], holder[l]);
+        physical[holder[g]] = g;
+        physical[holder[l]] = l;
+        ++num_exchanges;
+    };
+
+    // Queue a gate on physical positions on every slice it changes, all CUs running at once
+    auto launch = [&](const gate_desc& gate, const amp_t* matrix) {
+        for (int k = 0; k < num_cus; ++k) {
+            gate_desc local_gate;
+            amp_t local_matrix[GATE_MATRIX_SIZE];
+            if (!slice_gate(gate, matrix, k, local_qubits, local_gate, local_matrix)) {
+                continue;
+            }
+            xrt::bo& gate_bo = queues[k].stage(local_gate, local_matrix);
+
+            // Diagonal gates update the slice in place
+            int dst = (local_gate.type == GATE_DIAGONAL) ? src[k] : 1 - src[k];
+            profile_scope launch_scope(profile_gate_name(local_gate.type), "launch");
+            queues[k].push(kernels[k](state_bos[src[k]][k], gate_bo, state_bos[dst][k],
+                                      local_gate.type, local_gate.control, local_gate.target, local_qubits));
+            launch_scope.stop();
+            src[k] = dst;
+        }
+    };
+
+    // Gather the slices into host order, undoing the current layout
+    std::vector<amp_t> host_state;
+    auto read_state = [&]() {
+        drain();
+        std::vector<amp_t> gathered(slice_states * num_cus);
+        std::vector<amp_t> slice(slice_states);
+        for (int k = 0; k < num_cus; ++k) {
+            sync_bo(state_bos[src[k]][k], XCL_BO_SYNC_BO_FROM_DEVICE);
+            state_bos[src[k]][k].read(slice.data());
+            gather_vadd_state(slice.data(), gathered.data() + k * slice_states, slice_states);
+        }
+        host_state.resize(gathered.size());
+        for (size_t i = 0; i < gathered.size(); ++i) {
+            size_t j = 0;
+            for (int q = 0; q < num_qubits; ++q) {
+                j |= ((i >> q) & 1) << physical[q];
+            }
+            host_state[i] = gathered[j];
+        }
+    };
+
+    // Apply gates sequentially
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < circuit.num_gates; ++i) {
+        const gate_desc& gate = circuit.gates[i];
+
+        // Bring the qubits the gate cannot leave global into the highest free local positions
+        const int qubits[2] = {gate.target, gate.control};
+        for (int q : qubits) {
+            if (q < 0 || !slice_needs_local(map_gate(gate, physical), physical[q], local_qubits)) {
+                continue;
+            }
+            int free_slot = local_qubits - 1;
+            while (holder[free_slot] == gate.target || holder[free_slot] == gate.control) {
+                --free_slot;
+            }
+            exchange(physical[q], free_slot);
+        }
+        launch(map_gate(gate, physical), circuit.matrices + gate.matrix * GATE_MATRIX_SIZE);
+
+        if (options.debug_readback) {
+            read_state();
+            print_state(i, host_state.data(), num_qubits);
+        }
+    }
+
+    // Return every global position to its own qubit, then undo the remaining local
+    // permutation with GATE_PERMUTE passes on all slices
+    for (int g = local_qubits; g < num_qubits; ++g) {
+        if (holder[g] == g) {
+            continue;
+        }
+        if (physical[g] >= local_qubits) {
+            exchange(physical[g], local_qubits - 1);
+        }
+        exchange(g, physical[g]);
+    }
+    for (const auto& pairs : slice_restore_rounds(physical)) {
+        std::vector<gate_desc> records;
+        std::vector<amp_t> pool;
+        append_permute(records, pool, pairs);
+        for (const gate_desc& record : records) {
+            launch(record, pool.data() + record.matrix * GATE_MATRIX_SIZE);
+        }
+    }
+    for (int q = 0; q < num_qubits; ++q) {
+        physical[q] = q;
+        holder[q] = q;
+    }
+    drain();
+    print_timing("FPGA", circuit.num_gates, start);
+    std::cout << num_cus << " compute units, " << num_exchanges << " slice exchanges\n";
+
+    if (measure_requested(options)) {
+#ifdef AMP_LAYOUT_SOA
+        read_state();
+        return measure_final_state(host_state.data(), num_qubits, options);
+#else
+        // The layout is restored, so slice k is chunk k in DDR[k]
+        std::vector<xrt::bo> slices;
+        for (int k = 0; k < num_cus; ++k) {
+            slices.push_back(state_bos[src[k]][k]);
+        }
+        return measure_on_device(device, uuid, slices.data(), num_cus, 0, num_qubits, options);
+#endif
+    }
+    if (options.outputMode == "none") {
+        return 0;
+    }
+
+    // Gather the slices and write the final state
+    read_state();
+    return write_final_state(host_state.data(), num_qubits, options.outputMode);
+}
+#endif
+
+// Function to run the gate list on the CPU backend (cpu_backend.h) and write the final state
+int run_cpu(const gate_list_view& circuit, const run_options& options) {
+    size_t state_bytes = (size_t(1) << circuit.num_qubits) * sizeof(amp_t);
+    state_bytes = (state_bytes + 63) & ~size_t(63);  // aligned_alloc needs a multiple of the alignment
+
+    std::unique_ptr<amp_t, decltype(&std::free)> state(static_cast<amp_t*>(std::aligned_alloc(64, state_bytes)), &std::free);
+    if (!state) {
+        std::cerr << "Unable to allocate " << state_bytes << " bytes for the state vector\n";
+        return 1;
+    }
+    cpu_init_state(state.get(), circuit.num_qubits);
+
+    std::vector<double> kernel_us;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < circuit.num_gates; ++i) {
+        const gate_desc& gate = circuit.gates[i];
+        auto gate_start = std::chrono::steady_clock::now();
+        profile_scope gate_scope(profile_gate_name(gate.type), "cpu");
+        if (gate.type == GATE_BLOCK) {
+            cpu_apply_block(state.get(), &circuit.gates[i + 1], gate.control, circuit.matrices, gate.target, circuit.num_qubits);
+            i += gate.control;
+        } else {
+            cpu_apply_gate(state.get(), gate, circuit.matrices + gate.matrix * GATE_MATRIX_SIZE, circuit.num_qubits);
+        }
+        gate_scope.stop();
+        if (!options.bench_file.empty()) {
+            kernel_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - gate_start).count());
+        }
+
+        if (options.debug_readback) {
+            print_state(i, state.get(), circuit.num_qubits);
+        }
+    }
+    print_timing("CPU", circuit.num_gates, start);
+    if (!options.bench_file.empty() && write_bench(options.bench_file, circuit, kernel_us) != 0) {
+        return 1;
+    }
+
+    if (measure_requested(options)) {
+        return measure_final_state(state.get(), circuit.num_qubits, options);
+    }
+    if (options.outputMode == "none") {
+        return 0;
+    }
+    return write_final_state(state.get(), circuit.num_qubits, options.outputMode);
+}
+
+int main(int argc, char** argv) {
+    std::string gatesFile = "../quantum_circuit_gates.csv";
+    run_options options;
+    options.binaryFile = "./vadd.xclbin";
+    options.device_index = 0;
+    options.circuit_mode = false;
+    options.banked = false;
+    options.num_cus = 1;
+    options.wide = false;
+    options.in_place = false;
+    options.num_chunks = 1;
+    options.stream_qubits = 0;
+    options.debug_readback = false;
+    options.bench_file = "";
+    options.num_shots = 0;
+    options.shot_seed = 1;
+    options.outputMode = "binary";
+
+    // Parse command line options
+    // --backend <name>: fpga (default) or cpu (cpu_backend.h, no device needed)
+    // --debug-readback: read the state back from the device after every gate (verification only)
+    // --bench <file>:   time every gate record (waiting for each launch) and write the times to
+    //                   <file> as CSV; per-gate FPGA modes and the CPU backend (Scripts/bench.py)
+    // --circuit:        run the whole gate list in a single vadd_circuit launch
+    // --banked:         one vadd_banked launch per gate, state striped over DDR[0..3]
+    // --wide:           one vadd_wide launch per gate (512-bit datapath, 3+ qubits, 4+ at 16 bits)
+    // --in-place:       one vadd_inplace launch per gate on a single state buffer
+    // --chunks <n>:     with --in-place, split the state over n buffers (1, 2 or 4), one per bank
+    // --stream <qubits>: keep the state in host memory and stream chunks of 2^qubits
+    //                   amplitudes through vadd_circuit, one batch of gates per pass
+    // --cus <n>:        split the state into n slices (1, 2 or 4) on n vadd compute units
+    // --gates <file>:   OpenQASM 2.0 file (.qasm) or gate list CSV produced by Qasm2CSV.ipynb
+    //                   or compiled circuit (.q2sv) written by --compile
+    // --generate <spec>: generate a synthetic circuit instead of reading --gates, e.g.
+    //                   random,qubits=28,depth=20,seed=7,targets=high (circuit_generator.h)
+    // --no-fusion:      keep every single-qubit gate as its own kernel pass
+    // --compile <file>: write the (fused) gate list as a compiled circuit and exit
+    // --tile <qubits>:  group runs of gates below this qubit into tile blocks, one state pass
+    //                   per block (CPU backend or --circuit; at most GATE_TILE_MAX_QUBITS on the FPGA)
+    // --remap:          move the qubits of upcoming gates below the tile size with permutation
+    //                   passes where that saves passes (needs --tile)
+    // --profile:        print a table of time and bytes per host phase at exit (profiler.h);
+    //                   the Q2SV_PROFILE=1 environment variable does the same
+    // --trace <file>:   also write every phase as a Chrome trace-event JSON timeline
+    //                   (or Q2SV_TRACE=<file>); implies --profile
+    // --shots <n>:      draw n measurement shots from the final state (vadd_sample on the
+    //                   device where the state layout allows) and write shot_counts.csv
+    //                   instead of the state
+    // --shot-seed <n>:  seed of the shots (default 1)
+    // --expect <file>:  evaluate the Pauli strings in <file> on the final state (vadd_expect
+    //                   on the device where the state layout allows) and write
+    //                   expectations.csv instead of the state; combines with --shots
+    // --output <mode>:  final state output: binary (default, final_state_vector.q2st),
+    //                   text (final_state_vector.csv) or none (timing runs)
+    // --convert-state <in.q2st> <out.csv>: convert a binary state file to text and exit
+#ifdef Q2SV_CPU_ONLY
+    std::string backend = "cpu";
+#else
+    std::string backend = "fpga";
+#endif
+    bool fusion = true;
+    int tile_qubits = 0;
+    bool remap = false;
+    std::string compileFile;
+    std::string generateSpec;
+    std::string expectFile;
+    bool profile = false;
+    std::string traceFile;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--debug-readback") {
+            options.debug_readback = true;
+        } else if (arg == "--bench" && i + 1 < argc) {
+            options.bench_file = argv[++i];
+        } else if (arg == "--generate" && i + 1 < argc) {
+            generateSpec = argv[++i];
+        } else if (arg == "--shots" && i + 1 < argc) {
+            options.num_shots = std::atoll(argv[++i]);
+            if (options.num_shots < 1) {
+                std::cerr << "Invalid shot count: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--expect" && i + 1 < argc) {
+            expectFile = argv[++i];
+        } else if (arg == "--shot-seed" && i + 1 < argc) {
+            options.shot_seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--profile") {
+            profile = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            traceFile = argv[++i];
+        } else if (arg == "--circuit") {
+            options.circuit_mode = true;
+        } else if (arg == "--banked") {
+            options.banked = true;
+        } else if (arg == "--wide") {
+            options.wide = true;
+        } else if (arg == "--stream" && i + 1 < argc) {
+            options.stream_qubits = std::atoi(argv[++i]);
+            if (options.stream_qubits < STREAM_MAX_SELECT || options.stream_qubits > 30) {
+                std::cerr << "Invalid stream chunk size: " << argv[i] << " (" << STREAM_MAX_SELECT << " to 30 qubits)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--in-place") {
+            options.in_place = true;
+        } else if (arg == "--chunks" && i + 1 < argc) {
+            options.num_chunks = std::atoi(argv[++i]);
+            if (options.num_chunks < 1 || options.num_chunks > 4 || (options.num_chunks & (options.num_chunks - 1)) != 0) {
+                std::cerr << "Invalid chunk count: " << argv[i] << " (1, 2 or 4)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--cus" && i + 1 < argc) {
+            options.num_cus = std::atoi(argv[++i]);
+            if (options.num_cus < 1 || options.num_cus > SLICE_MAX_CUS || (options.num_cus & (options.num_cus - 1)) != 0) {
+                std::cerr << "Invalid compute unit count: " << argv[i] << " (1, 2 or 4)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--backend" && i + 1 < argc) {
+            backend = argv[++i];
+            if (backend != "fpga" && backend != "cpu") {
+                std::cerr << "Unknown backend: " << backend << std::endl;
+                return 1;
+            }
+        } else if (arg == "--no-fusion") {
+            fusion = false;
+        } else if (arg == "--gates" && i + 1 < argc) {
+            gatesFile = argv[++i];
+        } else if (arg == "--remap") {
+            remap = true;
+        } else if (arg == "--tile" && i + 1 < argc) {
+            tile_qubits = std::atoi(argv[++i]);
+            if (tile_qubits < 1) {
+                std::cerr << "Invalid tile size: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--compile" && i + 1 < argc) {
+            compileFile = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            options.outputMode = argv[++i];
+            if (options.outputMode != "binary" && options.outputMode != "text" && options.outputMode != "none") {
+                std::cerr << "Unknown output mode: " << options.outputMode << std::endl;
+                return 1;
+            }
+        } else if (arg == "--convert-state" && i + 2 < argc) {
+            std::string input = argv[++i];
+            std::string output = argv[++i];
+            try {
+                convert_state_to_text(input, output);
+            } catch (const std::exception& e) {
+                std::cerr << "Error converting " << input << ": " << e.what() << std::endl;
+                return 1;
+            }
+            std::cout << "State vector written to " << output << "\n";
+            return 0;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    // The summary (and trace) is reported when session goes out of scope at the end of main
+    profile_configure(profile, traceFile);
+    profile_session session;
+
+    // Read gates and number of qubits from the gate file
+    std::vector<gate_desc> gates;
+    std::vector<amp_t> gate_matrices;
+    std::unique_ptr<mapped_circuit> compiled;
+    int num_qubits = 0;
+
+    auto has_suffix = [&](const std::string& suffix) {
+        return gatesFile.size() >= suffix.size() &&
+               gatesFile.compare(gatesFile.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+
+    profile_scope read_scope(generateSpec.empty() ? "read gates" : "generate circuit", "io");
+    try {
+        if (!generateSpec.empty()) {
+            generator_spec spec = parse_generator_spec(generateSpec);
+            generate_circuit(spec, gates, gate_matrices, num_qubits);
+            std::cout << "Generated " << spec.kind << " circuit (depth " << spec.depth << ", seed " << spec.seed
+                      << ", " << spec.targets << " targets)\n";
+        } else if (has_suffix(".q2sv")) {
+            compiled.reset(new mapped_circuit(gatesFile));
+            num_qubits = compiled->num_qubits();
+            // Fall back to the in-memory list only if the file still needs fusing
+            if (fusion && !(compiled->header().flags & CIRCUIT_FILE_FUSED)) {
+                gates.assign(compiled->gates(), compiled->gates() + compiled->num_gates());
+                gate_matrices.assign(compiled->matrices(), compiled->matrices() + compiled->num_matrix_entries());
+                compiled.reset();
+            }
+        } else if (has_suffix(".qasm")) {
+            read_qasm(gatesFile, gates, gate_matrices, num_qubits);
+        } else {
+            read_gates(gatesFile, gates, gate_matrices, num_qubits);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error reading gates from " << (generateSpec.empty() ? gatesFile : generateSpec) << ": " << e.what() << std::endl;
+        return 1;
+    }
+    read_scope.stop();
+
+    // Fuse chains of single-qubit gates so each chain costs one state sweep
+    if (fusion && !compiled) {
+        profile_scope scope("gate fusion", "host");
+        size_t original_count = gates.size();
+        size_t removed = fuse_single_qubit_gates(gates, gate_matrices, num_qubits);
+        std::cout << "Gate fusion removed " << removed << " of " << original_count << " gates\n";
+    }
+
+    // Gate list handed to the kernels: either the mapped compiled circuit or the parsed list
+    const gate_desc* gate_list = compiled ? compiled->gates() : gates.data();
+    size_t num_gates = compiled ? compiled->num_gates() : gates.size();
+    const amp_t* matrix_pool = compiled ? compiled->matrices() : gate_matrices.data();
+    size_t num_matrix_entries = compiled ? compiled->num_matrix_entries() : gate_matrices.size();
+
+    if (!compileFile.empty()) {
+        profile_scope scope("write circuit", "io");
+        try {
+            write_circuit_file(compileFile, gate_list, num_gates, matrix_pool, num_matrix_entries, num_qubits,
+                               fusion ? CIRCUIT_FILE_FUSED : 0);
+        } catch (const std::exception& e) {
+            std::cerr << "Error writing " << compileFile << ": " << e.what() << std::endl;
+            return 1;
+        }
+        std::cout << "Compiled " << num_gates << " gates on " << num_qubits << " qubits to " << compileFile << "\n";
+        return 0;
+    }
+
+    if (tile_qubits > 0) {
+        if (backend == "fpga" && (!options.circuit_mode || options.banked)) {
+            std::cerr << "--tile needs --circuit or --backend cpu (the per-gate vadd kernel has no tile path)\n";
+            return 1;
+        }
+        if (backend == "fpga" && tile_qubits > GATE_TILE_MAX_QUBITS) {
+            std::cerr << "--tile is limited to " << GATE_TILE_MAX_QUBITS << " qubits on the FPGA\n";
+            return 1;
+        }
+        tile_qubits = std::min(tile_qubits, num_qubits);
+    } else if (remap) {
+        std::cerr << "--remap needs --tile\n";
+        return 1;
+    }
+
+    // Move hot qubits to low positions; this adds permutation records, so a mapped compiled
+    // circuit is copied into the in-memory list first
+    if (remap) {
+        if (compiled) {
+            gates.assign(gate_list, gate_list + num_gates);
+            gate_matrices.assign(matrix_pool, matrix_pool + num_matrix_entries);
+            compiled.reset();
+        }
+        profile_scope scope("qubit remap", "host");
+        remap_stats stats = remap_qubits(gates, gate_matrices, num_qubits, tile_qubits);
+        double saved_mb = 2.0 * (stats.passes_before - stats.passes_after) * (double(sizeof(amp_t)) * (size_t(1) << num_qubits)) / (1 << 20);
+        std::cout << "Qubit remapping inserted " << stats.remaps << " permutation passes: " << stats.passes_before
+                  << " -> " << stats.passes_after << " state passes (" << saved_mb << " MB less state traffic)\n";
+        gate_list = gates.data();
+        num_gates = gates.size();
+        matrix_pool = gate_matrices.data();
+        num_matrix_entries = gate_matrices.size();
+    }
+
+    // Group low-qubit gate runs into tile blocks; the member records still index the same pool
+    std::vector<gate_desc> blocked_gates;
+    if (tile_qubits > 0) {
+        profile_scope scope("gate tiling", "host");
+        size_t num_blocks = build_gate_blocks(gate_list, num_gates, tile_qubits, blocked_gates);
+        std::cout << "Tiling (" << tile_qubits << " qubits) formed " << num_blocks << " blocks: "
+                  << count_state_passes(gate_list, num_gates) << " -> "
+                  << count_state_passes(blocked_gates.data(), blocked_gates.size()) << " state passes\n";
+        gate_list = blocked_gates.data();
+        num_gates = blocked_gates.size();
+    }
+
+    std::cout << num_gates << " gate records on " << num_qubits << " qubits\n";
+#ifdef AMP_LAYOUT_SOA
+    std::cout << "Amplitudes: complex " << AMP_PRECISION_NAME << ", planar vadd buffers\n";
+#else
+    std::cout << "Amplitudes: complex " << AMP_PRECISION_NAME << "\n";
+#endif
+
+    // Read the observables before running, so a bad file fails early
+    if (!expectFile.empty()) {
+        try {
+            options.observables = read_observables(expectFile, num_qubits);
+        } catch (const std::exception& e) {
+            std::cerr << "Error reading Pauli strings from " << expectFile << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    gate_list_view circuit = {gate_list, num_gates, matrix_pool, num_matrix_entries, num_qubits};
+    if (backend == "cpu") {
+        return run_cpu(circuit, options);
+    }
+#ifdef Q2SV_CPU_ONLY
+    std::cerr << "This build has no FPGA backend (Q2SV_CPU_ONLY); use --backend cpu\n";
+    return 1;
+#else
+    // vadd_wide needs one 512-bit word of state: 8 amplitudes, or 16 at 16-bit precisions
+    const int wide_qubits = (AMP_SCALAR_BITS == 16) ? 4 : 3;
+    if (options.wide && (options.circuit_mode || options.banked || options.num_cus > 1 || num_qubits < wide_qubits)) {
+        std::cerr << "--wide is a per-gate mode for " << wide_qubits
+                  << "+ qubits and cannot be combined with --circuit, --banked or --cus\n";
+        return 1;
+    }
+    if (options.wide && sizeof(amp_scalar_t) * 8 != AMP_SCALAR_BITS) {
+        std::cerr << "--wide needs amplitude parts stored in exactly " << AMP_SCALAR_BITS << " bits\n";
+        return 1;
+    }
+    if (options.in_place && (options.circuit_mode || options.banked || options.wide || options.num_cus > 1)) {
+        std::cerr << "--in-place is a per-gate mode and cannot be combined with --circuit, --banked, --wide or --cus\n";
+        return 1;
+    }
+    if (options.num_chunks > 1 && !options.in_place) {
+        std::cerr << "--chunks needs --in-place\n";
+        return 1;
+    }
+    if (!options.bench_file.empty() && (options.circuit_mode || options.stream_qubits > 0 || options.num_cus > 1)) {
+        std::cerr << "--bench times single launches and cannot be combined with --circuit, --stream or --cus\n";
+        return 1;
+    }
+    if (options.stream_qubits > 0) {
+        if (options.circuit_mode || options.banked || options.wide || options.in_place || options.num_cus > 1) {
+            std::cerr << "--stream cannot be combined with other kernel modes\n";
+            return 1;
+        }
+        return run_fpga_stream(circuit, options);
+    }
+    if (num_qubits > 30 && !options.in_place) {
+        std::cerr << "More than 30 qubits needs --in-place or --stream (the other kernels use 32-bit indices)\n";
+        return 1;
+    }
+    if (options.in_place) {
+        return run_fpga_in_place(circuit, options);
+    }
+    if (options.banked) {
+        if (options.circuit_mode || options.num_cus > 1) {
+            std::cerr << "--banked cannot be combined with --circuit or --cus\n";
+            return 1;
+        }
+        return run_fpga_banked(circuit, options);
+    }
+    if (options.num_cus > 1) {
+        if (options.circuit_mode) {
+            std::cerr << "--cus and --circuit cannot be combined\n";
+            return 1;
+        }
+        return run_fpga_multi_cu(circuit, options);
+    }
+    return run_fpga(circuit, options);
+#endif
+}
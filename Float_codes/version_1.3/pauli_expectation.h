@@ -0,0 +1,139 @@
+#ifndef PAULI_EXPECTATION_H
+#define PAULI_EXPECTATION_H
+
+// Expectation values <psi|P|psi> of Pauli strings, shared by the vadd_expect kernel and the
+// host (CPU backend, --stream and the planar vadd buffers), so the state never has to be
+// written out for them.
+//
+// A Pauli string is two masks: x_mask holds the qubits with X or Y, z_mask those with Z or
+// Y. With Y = iXZ, P|j> = i^y (-1)^popcount(j & z_mask) |j ^ x_mask>, y = popcount(x & z),
+// so
+//     <psi|P|psi> = i^y sum_j conj(psi[j ^ x_mask]) psi[j] (-1)^popcount(j & z_mask)
+// The sum runs over the pairs (j, j ^ x_mask), each amplitude read once. Every string with
+// the same x_mask reads the same pairs, so the host sorts the strings by x_mask and one pass
+// over the state evaluates a group of up to PAULI_GROUP_MAX_TERMS of them; only their Z
+// signs differ. Products are formed in float and summed in double.
+
+#include "gate_desc.h"
+
+// Strings evaluated per pass over the state (same x_mask)
+#define PAULI_GROUP_MAX_TERMS 8
+
+// One Pauli string
+struct pauli_term {
+    long long x_mask;   // Qubits with X or Y
+    long long z_mask;   // Qubits with Z or Y
+};
+
+// Function to get the parity of the set bits of v (an xor tree in hardware)
+inline int pauli_parity(long long v) {
+    unsigned long long u = static_cast<unsigned long long>(v);
+    u ^= u >> 32;
+    u ^= u >> 16;
+    u ^= u >> 8;
+    u ^= u >> 4;
+    u ^= u >> 2;
+    u ^= u >> 1;
+    return static_cast<int>(u & 1);
+}
+
+// Function to count the strings from `first` on that share its x_mask, at most
+// PAULI_GROUP_MAX_TERMS (the terms are sorted by x_mask)
+inline int pauli_group_size(const pauli_term *terms, int first, int num_terms) {
+    int size = 1;
+    while (first + size < num_terms && size < PAULI_GROUP_MAX_TERMS && terms[first + size].x_mask == terms[first].x_mask) {
+        ++size;
+    }
+    return size;
+}
+
+// Function to evaluate a group of strings with one x_mask in one pass over the state and
+// write their (real) expectation values to values[0..group_size)
+template <typename state_view>
+inline void pauli_group_expectation(const state_view &state, int num_qubits, const pauli_term *terms, int group_size,
+                                    double *values) {
+    long long z_masks[PAULI_GROUP_MAX_TERMS];
+    int phases[PAULI_GROUP_MAX_TERMS];      // y mod 4, the power of i
+    double sums[PAULI_GROUP_MAX_TERMS];
+    HLS_PRAGMA(HLS ARRAY_PARTITION variable=z_masks complete)
+    HLS_PRAGMA(HLS ARRAY_PARTITION variable=phases complete)
+    HLS_PRAGMA(HLS ARRAY_PARTITION variable=sums complete)
+    for (int t = 0; t < PAULI_GROUP_MAX_TERMS; ++t) {
+        HLS_PRAGMA(HLS UNROLL)
+        z_masks[t] = (t < group_size) ? terms[t].z_mask : 0;
+        phases[t] = 0;
+        sums[t] = 0.0;
+    }
+    const long long x_mask = terms[0].x_mask;
+    for (int t = 0; t < group_size; ++t) {
+        long long y = x_mask & z_masks[t];
+        int count = 0;
+        for (int q = 0; q < num_qubits; ++q) {
+            count += (y >> q) & 1;
+        }
+        phases[t] = count & 3;
+    }
+
+    // Pairs (j, j ^ x_mask) with j's copy of the top X bit clear; without X, pairs of
+    // neighbours (j, j + 1), each amplitude counted with its own sign
+    int pair_bit = 0;
+    for (int q = 0; q < num_qubits; ++q) {
+        if ((x_mask >> q) & 1) {
+            pair_bit = q;
+        }
+    }
+    const long long partner_mask = (x_mask != 0) ? x_mask : 1;
+    const long long num_pairs = 1LL << (num_qubits - 1);
+    HLS_LABEL(pair_loop) for (long long k = 0; k < num_pairs; ++k) {
+        HLS_PRAGMA(HLS PIPELINE)
+        long long j = ((k >> pair_bit) << (pair_bit + 1)) | (k & ((1LL << pair_bit) - 1));
+        long long partner = j ^ partner_mask;
+        amp_t a_amp = state[j];
+        amp_t b_amp = state[partner];
+        float a_re = static_cast<float>(a_amp.real()), a_im = static_cast<float>(a_amp.imag());
+        float b_re = static_cast<float>(b_amp.real()), b_im = static_cast<float>(b_amp.imag());
+        // c = conj(b) a; the partner contributes conj(a) b = conj(c)
+        float c_re = b_re * a_re + b_im * a_im;
+        float c_im = b_re * a_im - b_im * a_re;
+        float a_norm = a_re * a_re + a_im * a_im;
+        float b_norm = b_re * b_re + b_im * b_im;
+        for (int t = 0; t < PAULI_GROUP_MAX_TERMS; ++t) {
+            HLS_PRAGMA(HLS UNROLL)
+            float s_j = pauli_parity(j & z_masks[t]) ? -1.0f : 1.0f;
+            float s_partner = pauli_parity(partner & z_masks[t]) ? -1.0f : 1.0f;
+            float w;
+            if (x_mask == 0) {
+                w = s_j * a_norm + s_partner * b_norm;
+            } else {
+                // Real part of i^phase (s_j c + s_partner conj(c))
+                float w_re = (s_j + s_partner) * c_re;
+                float w_im = (s_j - s_partner) * c_im;
+                switch (phases[t]) {
+                case 0: w = w_re; break;
+                case 1: w = -w_im; break;
+                case 2: w = -w_re; break;
+                default: w = w_im; break;
+                }
+            }
+            sums[t] += w;
+        }
+    }
+
+    for (int t = 0; t < group_size; ++t) {
+        values[t] = sums[t];
+    }
+}
+
+// Function to evaluate terms[0..num_terms) (sorted by x_mask) into values, one pass per group
+template <typename state_view>
+inline void pauli_expectations(const state_view &state, int num_qubits, const pauli_term *terms, int num_terms,
+                               double *values) {
+    int first = 0;
+    HLS_LABEL(group_loop) while (first < num_terms) {
+        int size = pauli_group_size(terms, first, num_terms);
+        pauli_group_expectation(state, num_qubits, terms + first, size, values + first);
+        first += size;
+    }
+}
+
+#endif
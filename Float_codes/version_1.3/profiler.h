@@ -0,0 +1,204 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Host-side phase timing and byte counters (--profile, or the Q2SV_PROFILE environment
+// variable). A profile_scope measures one phase, e.g. reading the gate file, loading the
+// xclbin, a bo sync or a run.wait(), and may carry the number of bytes it moved. Scopes
+// with the same name are summed into one row of the summary table printed at exit; with
+// --trace <file> (or Q2SV_TRACE=<file>) every scope is also written as a Chrome trace event,
+// so the run can be viewed as a timeline in chrome://tracing or Perfetto.
+//
+// Disabled, a scope costs one branch on a global flag. Names are string literals (or the
+// static names of profile_gate_name); trace events keep them by pointer.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "gate_desc.h"
+
+// One completed scope, kept for the trace
+struct profile_event {
+    const char* name;
+    const char* category;
+    double start_us;        // Since profiler start
+    double duration_us;
+    uint64_t bytes;
+};
+
+// Totals of all scopes with one name
+struct profile_total {
+    const char* category;
+    uint64_t count;
+    double total_us;
+    double max_us;
+    uint64_t bytes;
+};
+
+struct profiler_state {
+    bool enabled;
+    std::string trace_file;
+    std::chrono::steady_clock::time_point origin;
+    std::map<std::string, profile_total> totals;
+    std::vector<std::string> order;     // Names in first-seen order, for the table
+    std::vector<profile_event> events;  // Only filled when trace_file is set
+};
+
+inline profiler_state& profiler() {
+    static profiler_state state = {false, "", std::chrono::steady_clock::now(), {}, {}, {}};
+    return state;
+}
+
+// Function to enable the profiler. Flag values take precedence; otherwise Q2SV_PROFILE=1
+// enables the summary and Q2SV_TRACE=<file> the trace (which implies the summary).
+inline void profile_configure(bool enable, const std::string& trace_file) {
+    profiler_state& state = profiler();
+    const char* env_profile = std::getenv("Q2SV_PROFILE");
+    const char* env_trace = std::getenv("Q2SV_TRACE");
+    state.trace_file = !trace_file.empty() ? trace_file : (env_trace ? env_trace : "");
+    state.enabled = enable || !state.trace_file.empty() ||
+                    (env_profile && *env_profile && std::strcmp(env_profile, "0") != 0);
+    state.origin = std::chrono::steady_clock::now();
+}
+
+inline bool profile_enabled() {
+    return profiler().enabled;
+}
+
+// Function to record a finished phase
+inline void profile_record(const char* name, const char* category, std::chrono::steady_clock::time_point start,
+                           std::chrono::steady_clock::time_point end, uint64_t bytes) {
+    profiler_state& state = profiler();
+    double start_us = std::chrono::duration<double, std::micro>(start - state.origin).count();
+    double duration_us = std::chrono::duration<double, std::micro>(end - start).count();
+
+    auto found = state.totals.find(name);
+    if (found == state.totals.end()) {
+        found = state.totals.emplace(name, profile_total{category, 0, 0.0, 0.0, 0}).first;
+        state.order.push_back(name);
+    }
+    profile_total& total = found->second;
+    ++total.count;
+    total.total_us += duration_us;
+    total.max_us = (duration_us > total.max_us) ? duration_us : total.max_us;
+    total.bytes += bytes;
+
+    if (!state.trace_file.empty()) {
+        state.events.push_back(profile_event{name, category, start_us, duration_us, bytes});
+    }
+}
+
+// Times the enclosing block when the profiler is enabled
+class profile_scope {
+public:
+    profile_scope(const char* name, const char* category, uint64_t bytes = 0)
+        : name_(name), category_(category), bytes_(bytes), active_(profile_enabled()) {
+        if (active_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+    ~profile_scope() {
+        stop();
+    }
+    void add_bytes(uint64_t bytes) {
+        bytes_ += bytes;
+    }
+    // Function to end the phase before the enclosing block does
+    void stop() {
+        if (active_) {
+            profile_record(name_, category_, start_, std::chrono::steady_clock::now(), bytes_);
+            active_ = false;
+        }
+    }
+
+private:
+    const char* name_;
+    const char* category_;
+    uint64_t bytes_;
+    bool active_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Function to get the scope name of one gate per gate kind (gate_type)
+inline const char* profile_gate_name(int type) {
+    static const char* const names[] = {"gate single", "gate cx", "gate controlled", "gate two-qubit",
+                                        "gate diagonal", "gate block", "gate permute"};
+    return (type >= 0 && type <= GATE_PERMUTE) ? names[type] : "gate other";
+}
+
+// Function to escape a name for JSON (names are plain literals, this is only a guard)
+inline std::string profile_json_string(const char* text) {
+    std::string out;
+    for (const char* p = text; *p; ++p) {
+        if (*p == '"' || *p == '\\') {
+            out += '\\';
+        }
+        out += *p;
+    }
+    return out;
+}
+
+// Function to print the summary table and write the trace, if enabled
+inline void profile_report() {
+    profiler_state& state = profiler();
+    if (!state.enabled) {
+        return;
+    }
+
+    double wall_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - state.origin).count();
+    std::ostream& out = std::cout;
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << "\nProfile (" << std::fixed << std::setprecision(3) << wall_us / 1e3 << " ms since start)\n";
+    out << std::left << std::setw(22) << "phase" << std::setw(10) << "category" << std::right
+        << std::setw(10) << "count" << std::setw(14) << "total ms" << std::setw(12) << "mean us"
+        << std::setw(12) << "max us" << std::setw(14) << "MB" << std::setw(10) << "GB/s" << "\n";
+    for (const std::string& name : state.order) {
+        const profile_total& total = state.totals[name];
+        out << std::left << std::setw(22) << name << std::setw(10) << total.category << std::right
+            << std::setw(10) << total.count << std::setw(14) << total.total_us / 1e3
+            << std::setw(12) << total.total_us / total.count << std::setw(12) << total.max_us;
+        if (total.bytes > 0) {
+            out << std::setw(14) << total.bytes / 1e6 << std::setw(10)
+                << ((total.total_us > 0) ? total.bytes / total.total_us / 1e3 : 0.0);
+        }
+        out << "\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+
+    if (state.trace_file.empty()) {
+        return;
+    }
+    std::ofstream trace(state.trace_file);
+    if (!trace.is_open()) {
+        std::cerr << "Unable to open " << state.trace_file << " for writing.\n";
+        return;
+    }
+    trace << "{\"traceEvents\":[\n";
+    trace << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < state.events.size(); ++i) {
+        const profile_event& event = state.events[i];
+        trace << "{\"name\":\"" << profile_json_string(event.name) << "\",\"cat\":\"" << profile_json_string(event.category)
+              << "\",\"ph\":\"X\",\"ts\":" << event.start_us << ",\"dur\":" << event.duration_us
+              << ",\"pid\":0,\"tid\":0,\"args\":{\"bytes\":" << event.bytes << "}}"
+              << ((i + 1 < state.events.size()) ? ",\n" : "\n");
+    }
+    trace << "],\"displayTimeUnit\":\"ms\"}\n";
+    std::cerr << "Trace with " << state.events.size() << " events written to " << state.trace_file << "\n";
+}
+
+// Prints the report when main returns, whichever path it takes
+struct profile_session {
+    ~profile_session() {
+        profile_report();
+    }
+};
+
+#endif
@@ -0,0 +1,751 @@
+#ifndef QASM_PARSER_H
+#define QASM_PARSER_H
+
+// OpenQASM 2.0 front end: reads a .qasm file straight into the packed gate list
+// (see gate_desc.h), replacing the Qasm2CSV.ipynb + CSV step.
+//
+// Supported: OPENQASM 2.0 header, include "qelib1.inc", qreg/creg, all qelib1.inc gates,
+// user gate definitions, register broadcasting, parameter expressions (pi, + - * / ^,
+// sin cos tan exp ln sqrt). barrier and measure are ignored, as Qasm2CSV.ipynb drops them;
+// reset, if and opaque are rejected. Two-qubit matrices follow the Qiskit ordering used by
+// Qasm2CSV.ipynb, so the gate list matches the CSV path gate for gate.
+
+#include <complex>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cmath>
+#include <cctype>
+#include <cstdlib>
+#include "gate_desc.h"
+#include "gate_list.h"
+
+// Multi-qubit qelib1.inc gates without a native kernel path, expanded into 1- and 2-qubit gates.
+// c4x undoes its first relative-phase rc3x with the inverse rc3xdg (as Qiskit's C4XGate does),
+// so it is exactly the 4-controlled X.
+static const char* const qelib1_composite_gates = R"QASM(
+gate ccx a,b,c
+{
+  h c;
+  cx b,c; tdg c;
+  cx a,c; t c;
+  cx b,c; tdg c;
+  cx a,c; t b; t c; h c;
+  cx a,b; t a; tdg b;
+  cx a,b;
+}
+gate cswap a,b,c
+{
+  cx c,b;
+  ccx a,b,c;
+  cx c,b;
+}
+gate rccx a,b,c
+{
+  u2(0,pi) c;
+  u1(pi/4) c;
+  cx b, c;
+  u1(-pi/4) c;
+  cx a, c;
+  u1(pi/4) c;
+  cx b, c;
+  u1(-pi/4) c;
+  u2(0,pi) c;
+}
+gate rc3x a,b,c,d
+{
+  u2(0,pi) d;
+  u1(pi/4) d;
+  cx c,d;
+  u1(-pi/4) d;
+  u2(0,pi) d;
+  cx a,d;
+  u1(pi/4) d;
+  cx b,d;
+  u1(-pi/4) d;
+  cx a,d;
+  u1(pi/4) d;
+  cx b,d;
+  u1(-pi/4) d;
+  u2(0,pi) d;
+  u1(pi/4) d;
+  cx c,d;
+  u1(-pi/4) d;
+  u2(0,pi) d;
+}
+gate rc3xdg a,b,c,d
+{
+  u2(0,pi) d;
+  u1(pi/4) d;
+  cx c,d;
+  u1(-pi/4) d;
+  u2(0,pi) d;
+  u1(pi/4) d;
+  cx b,d;
+  u1(-pi/4) d;
+  cx a,d;
+  u1(pi/4) d;
+  cx b,d;
+  u1(-pi/4) d;
+  cx a,d;
+  u2(0,pi) d;
+  u1(pi/4) d;
+  cx c,d;
+  u1(-pi/4) d;
+  u2(0,pi) d;
+}
+gate c3x a,b,c,d
+{
+  h d;
+  p(pi/8) a;
+  p(pi/8) b;
+  p(pi/8) c;
+  p(pi/8) d;
+  cx a, b;
+  p(-pi/8) b;
+  cx a, b;
+  cx b, c;
+  p(-pi/8) c;
+  cx a, c;
+  p(pi/8) c;
+  cx b, c;
+  p(-pi/8) c;
+  cx a, c;
+  cx c, d;
+  p(-pi/8) d;
+  cx b, d;
+  p(pi/8) d;
+  cx c, d;
+  p(-pi/8) d;
+  cx a, d;
+  p(pi/8) d;
+  cx c, d;
+  p(-pi/8) d;
+  cx b, d;
+  p(pi/8) d;
+  cx c, d;
+  p(-pi/8) d;
+  cx a, d;
+  h d;
+}
+gate c3sqrtx a,b,c,d
+{
+  h d; cu1(pi/8) a,d; h d;
+  cx a,b;
+  h d; cu1(-pi/8) b,d; h d;
+  cx a,b;
+  h d; cu1(pi/8) b,d; h d;
+  cx b,c;
+  h d; cu1(-pi/8) c,d; h d;
+  cx a,c;
+  h d; cu1(pi/8) c,d; h d;
+  cx b,c;
+  h d; cu1(-pi/8) c,d; h d;
+  cx a,c;
+  h d; cu1(pi/8) c,d; h d;
+}
+gate c4x a,b,c,d,e
+{
+  h e; cu1(pi/2) d,e; h e;
+  rc3x a,b,c,d;
+  h e; cu1(-pi/2) d,e; h e;
+  rc3xdg a,b,c,d;
+  c3sqrtx a,b,c,e;
+}
+)QASM";
+
+typedef std::complex<double> qasm_complex;
+
+// Gate matrix built in double precision (2x2 or 4x4, row-major)
+struct qasm_matrix {
+    int size = 2;
+    qasm_complex m[16];
+};
+
+// Function to build the generic single-qubit rotation U(theta, phi, lambda) of OpenQASM 2.0
+inline qasm_matrix qasm_u3(double theta, double phi, double lambda) {
+    const qasm_complex i(0.0, 1.0);
+    qasm_matrix u;
+    u.m[0] = std::cos(theta / 2);
+    u.m[1] = -std::exp(i * lambda) * std::sin(theta / 2);
+    u.m[2] = std::exp(i * phi) * std::sin(theta / 2);
+    u.m[3] = std::exp(i * (phi + lambda)) * std::cos(theta / 2);
+    return u;
+}
+
+inline qasm_matrix qasm_2x2(qasm_complex a, qasm_complex b, qasm_complex c, qasm_complex d) {
+    qasm_matrix u;
+    u.m[0] = a;
+    u.m[1] = b;
+    u.m[2] = c;
+    u.m[3] = d;
+    return u;
+}
+
+// Function to build the 4x4 matrix of u controlled on the first gate argument
+// (local index bit 0), in the Qiskit ordering
+inline qasm_matrix qasm_controlled(const qasm_matrix& u) {
+    qasm_matrix c;
+    c.size = 4;
+    c.m[0 * 4 + 0] = 1.0;
+    c.m[2 * 4 + 2] = 1.0;
+    c.m[1 * 4 + 1] = u.m[0];
+    c.m[1 * 4 + 3] = u.m[1];
+    c.m[3 * 4 + 1] = u.m[2];
+    c.m[3 * 4 + 3] = u.m[3];
+    return c;
+}
+
+// Function to build the matrix of a native qelib1.inc gate.
+// Returns false if the name is not a native gate or the parameter count is wrong.
+inline bool qasm_native_matrix(const std::string& name, const std::vector<double>& p, qasm_matrix& out) {
+    const double pi = M_PI;
+    const qasm_complex i(0.0, 1.0);
+    const double r = 1.0 / std::sqrt(2.0);
+    size_t n = p.size();
+
+    // Single-qubit gates
+    if ((name == "U" || name == "u3" || name == "u") && n == 3) { out = qasm_u3(p[0], p[1], p[2]); return true; }
+    if (name == "u2" && n == 2) { out = qasm_u3(pi / 2, p[0], p[1]); return true; }
+    if ((name == "u1" || name == "p") && n == 1) { out = qasm_2x2(1.0, 0.0, 0.0, std::exp(i * p[0])); return true; }
+    if ((name == "id" || name == "u0") && n <= 1) { out = qasm_2x2(1.0, 0.0, 0.0, 1.0); return true; }
+    if (name == "x" && n == 0) { out = qasm_2x2(0.0, 1.0, 1.0, 0.0); return true; }
+    if (name == "y" && n == 0) { out = qasm_2x2(0.0, -i, i, 0.0); return true; }
+    if (name == "z" && n == 0) { out = qasm_2x2(1.0, 0.0, 0.0, -1.0); return true; }
+    if (name == "h" && n == 0) { out = qasm_2x2(r, r, r, -r); return true; }
+    if (name == "s" && n == 0) { out = qasm_2x2(1.0, 0.0, 0.0, i); return true; }
+    if (name == "sdg" && n == 0) { out = qasm_2x2(1.0, 0.0, 0.0, -i); return true; }
+    if (name == "t" && n == 0) { out = qasm_2x2(1.0, 0.0, 0.0, std::exp(i * (pi / 4))); return true; }
+    if (name == "tdg" && n == 0) { out = qasm_2x2(1.0, 0.0, 0.0, std::exp(-i * (pi / 4))); return true; }
+    if (name == "rx" && n == 1) { out = qasm_2x2(std::cos(p[0] / 2), -i * std::sin(p[0] / 2), -i * std::sin(p[0] / 2), std::cos(p[0] / 2)); return true; }
+    if (name == "ry" && n == 1) { out = qasm_2x2(std::cos(p[0] / 2), -std::sin(p[0] / 2), std::sin(p[0] / 2), std::cos(p[0] / 2)); return true; }
+    if (name == "rz" && n == 1) { out = qasm_2x2(std::exp(-i * (p[0] / 2)), 0.0, 0.0, std::exp(i * (p[0] / 2))); return true; }
+    if (name == "sx" && n == 0) { out = qasm_2x2(0.5 + 0.5 * i, 0.5 - 0.5 * i, 0.5 - 0.5 * i, 0.5 + 0.5 * i); return true; }
+    if (name == "sxdg" && n == 0) { out = qasm_2x2(0.5 - 0.5 * i, 0.5 + 0.5 * i, 0.5 + 0.5 * i, 0.5 - 0.5 * i); return true; }
+
+    // Controlled two-qubit gates (control is the first argument)
+    qasm_matrix u;
+    if ((name == "cx" || name == "CX") && n == 0) { qasm_native_matrix("x", p, u); out = qasm_controlled(u); return true; }
+    if (name == "cy" && n == 0) { qasm_native_matrix("y", p, u); out = qasm_controlled(u); return true; }
+    if (name == "cz" && n == 0) { qasm_native_matrix("z", p, u); out = qasm_controlled(u); return true; }
+    if (name == "ch" && n == 0) { qasm_native_matrix("h", p, u); out = qasm_controlled(u); return true; }
+    if (name == "csx" && n == 0) { qasm_native_matrix("sx", p, u); out = qasm_controlled(u); return true; }
+    if (name == "crx" && n == 1) { qasm_native_matrix("rx", p, u); out = qasm_controlled(u); return true; }
+    if (name == "cry" && n == 1) { qasm_native_matrix("ry", p, u); out = qasm_controlled(u); return true; }
+    if (name == "crz" && n == 1) { qasm_native_matrix("rz", p, u); out = qasm_controlled(u); return true; }
+    if ((name == "cu1" || name == "cp") && n == 1) { qasm_native_matrix("u1", p, u); out = qasm_controlled(u); return true; }
+    if (name == "cu3" && n == 3) { out = qasm_controlled(qasm_u3(p[0], p[1], p[2])); return true; }
+    if (name == "cu" && n == 4) {
+        u = qasm_u3(p[0], p[1], p[2]);
+        for (int k = 0; k < 4; ++k) {
+            u.m[k] *= std::exp(i * p[3]);
+        }
+        out = qasm_controlled(u);
+        return true;
+    }
+
+    // Other two-qubit gates
+    if (name == "swap" && n == 0) {
+        out = qasm_matrix();
+        out.size = 4;
+        out.m[0 * 4 + 0] = 1.0;
+        out.m[1 * 4 + 2] = 1.0;
+        out.m[2 * 4 + 1] = 1.0;
+        out.m[3 * 4 + 3] = 1.0;
+        return true;
+    }
+    if (name == "rxx" && n == 1) {
+        out = qasm_matrix();
+        out.size = 4;
+        for (int l = 0; l < 4; ++l) {
+            out.m[l * 4 + l] = std::cos(p[0] / 2);
+            out.m[l * 4 + (3 - l)] = -i * std::sin(p[0] / 2);
+        }
+        return true;
+    }
+    if (name == "rzz" && n == 1) {
+        out = qasm_matrix();
+        out.size = 4;
+        for (int l = 0; l < 4; ++l) {
+            bool odd_parity = ((l & 1) ^ (l >> 1)) != 0;
+            out.m[l * 4 + l] = std::exp(i * (odd_parity ? p[0] / 2 : -p[0] / 2));
+        }
+        return true;
+    }
+
+    return false;
+}
+
+// Number of qubit arguments of a native gate (1 or 2)
+inline int qasm_native_arity(const qasm_matrix& m) {
+    return (m.size == 2) ? 1 : 2;
+}
+
+// Lexical token of the QASM source
+struct qasm_token {
+    enum kind_t { END, IDENT, NUMBER, STRING, SYMBOL } kind = END;
+    std::string_view text;
+    double number = 0.0;
+    int line = 0;
+};
+
+// Gate defined with a `gate` statement (user code or the composite qelib1.inc gates)
+struct qasm_gate_def {
+    std::vector<std::string> params;
+    std::vector<std::string> args;
+    std::vector<qasm_token> body;
+};
+
+class qasm_parser {
+public:
+    qasm_parser(std::vector<gate_desc>& gates, std::vector<amp_t>& gate_matrices)
+        : gates_(gates), gate_matrices_(gate_matrices) {}
+
+    // Function to parse a complete QASM program held in source
+    void parse(const std::string& source) {
+        tokens_ = tokenize(source);
+        pos_ = 0;
+        while (peek().kind != qasm_token::END) {
+            statement();
+        }
+    }
+
+    int num_qubits() const { return num_qubits_; }
+
+private:
+    std::vector<gate_desc>& gates_;
+    std::vector<amp_t>& gate_matrices_;
+    std::vector<qasm_token> tokens_;
+    size_t pos_ = 0;
+    int num_qubits_ = 0;
+    std::map<std::string, std::pair<int, int>> qregs_;  // name -> (first qubit, size)
+    std::map<std::string, qasm_gate_def> gate_defs_;
+    std::string composite_source_;                       // Keeps the qelib1 token text alive
+
+    [[noreturn]] void fail(const std::string& message, int line) const {
+        throw std::runtime_error("QASM line " + std::to_string(line) + ": " + message);
+    }
+
+    static std::vector<qasm_token> tokenize(const std::string& source) {
+        std::vector<qasm_token> tokens;
+        const char* p = source.data();
+        const char* end = p + source.size();
+        int line = 1;
+
+        while (p < end) {
+            char c = *p;
+            if (c == '\n') {
+                ++line;
+                ++p;
+            } else if (std::isspace(static_cast<unsigned char>(c))) {
+                ++p;
+            } else if (c == '/' && p + 1 < end && p[1] == '/') {
+                while (p < end && *p != '\n') {
+                    ++p;
+                }
+            } else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                const char* start = p;
+                while (p < end && (std::isalnum(static_cast<unsigned char>(*p)) || *p == '_')) {
+                    ++p;
+                }
+                tokens.push_back({qasm_token::IDENT, std::string_view(start, p - start), 0.0, line});
+            } else if (std::isdigit(static_cast<unsigned char>(c)) || (c == '.' && p + 1 < end && std::isdigit(static_cast<unsigned char>(p[1])))) {
+                char* number_end = nullptr;
+                double value = std::strtod(p, &number_end);
+                tokens.push_back({qasm_token::NUMBER, std::string_view(p, number_end - p), value, line});
+                p = number_end;
+            } else if (c == '"') {
+                const char* start = ++p;
+                while (p < end && *p != '"') {
+                    ++p;
+                }
+                tokens.push_back({qasm_token::STRING, std::string_view(start, p - start), 0.0, line});
+                ++p;
+            } else if (c == '-' && p + 1 < end && p[1] == '>') {
+                tokens.push_back({qasm_token::SYMBOL, std::string_view(p, 2), 0.0, line});
+                p += 2;
+            } else if (c == '=' && p + 1 < end && p[1] == '=') {
+                tokens.push_back({qasm_token::SYMBOL, std::string_view(p, 2), 0.0, line});
+                p += 2;
+            } else {
+                tokens.push_back({qasm_token::SYMBOL, std::string_view(p, 1), 0.0, line});
+                ++p;
+            }
+        }
+        tokens.push_back({qasm_token::END, std::string_view(), 0.0, line});
+        return tokens;
+    }
+
+    const qasm_token& peek() const { return tokens_[pos_]; }
+    const qasm_token& next() { return tokens_[pos_ < tokens_.size() - 1 ? pos_++ : pos_]; }
+
+    bool accept(std::string_view symbol) {
+        if (peek().kind == qasm_token::SYMBOL && peek().text == symbol) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(std::string_view symbol) {
+        if (!accept(symbol)) {
+            fail("expected '" + std::string(symbol) + "' but found '" + std::string(peek().text) + "'", peek().line);
+        }
+    }
+
+    std::string identifier() {
+        const qasm_token& t = next();
+        if (t.kind != qasm_token::IDENT) {
+            fail("expected an identifier but found '" + std::string(t.text) + "'", t.line);
+        }
+        return std::string(t.text);
+    }
+
+    int integer() {
+        const qasm_token& t = next();
+        if (t.kind != qasm_token::NUMBER) {
+            fail("expected an integer but found '" + std::string(t.text) + "'", t.line);
+        }
+        return static_cast<int>(t.number);
+    }
+
+    void statement() {
+        const qasm_token& t = peek();
+        if (t.kind != qasm_token::IDENT) {
+            fail("unexpected '" + std::string(t.text) + "'", t.line);
+        }
+
+        if (t.text == "OPENQASM") {
+            next();
+            next();  // Version number
+            expect(";");
+        } else if (t.text == "include") {
+            next();
+            const qasm_token& file = next();
+            if (file.kind != qasm_token::STRING || file.text != "qelib1.inc") {
+                fail("only include \"qelib1.inc\" is supported", file.line);
+            }
+            expect(";");
+            load_composite_gates();
+        } else if (t.text == "qreg" || t.text == "creg") {
+            bool quantum = (t.text == "qreg");
+            next();
+            std::string name = identifier();
+            expect("[");
+            int size = integer();
+            expect("]");
+            expect(";");
+            if (quantum) {
+                qregs_[name] = std::make_pair(num_qubits_, size);
+                num_qubits_ += size;
+            }
+        } else if (t.text == "gate") {
+            next();
+            gate_definition();
+        } else if (t.text == "barrier" || t.text == "measure") {
+            // No effect on the simulated state vector
+            while (!accept(";")) {
+                if (next().kind == qasm_token::END) {
+                    fail("missing ';'", t.line);
+                }
+            }
+        } else if (t.text == "reset" || t.text == "if" || t.text == "opaque") {
+            fail("'" + std::string(t.text) + "' is not supported by the state vector simulator", t.line);
+        } else {
+            gate_call_statement();
+        }
+    }
+
+    void load_composite_gates() {
+        // Parse the composite gate definitions with a nested parser sharing gate_defs_
+        composite_source_ = qelib1_composite_gates;
+        std::vector<qasm_token> saved_tokens;
+        saved_tokens.swap(tokens_);
+        size_t saved_pos = pos_;
+
+        tokens_ = tokenize(composite_source_);
+        pos_ = 0;
+        while (peek().kind != qasm_token::END) {
+            statement();
+        }
+
+        tokens_.swap(saved_tokens);
+        pos_ = saved_pos;
+    }
+
+    void gate_definition() {
+        qasm_gate_def def;
+        std::string name = identifier();
+        if (accept("(")) {
+            if (!accept(")")) {
+                do {
+                    def.params.push_back(identifier());
+                } while (accept(","));
+                expect(")");
+            }
+        }
+        do {
+            def.args.push_back(identifier());
+        } while (accept(","));
+        expect("{");
+        int depth = 1;
+        while (depth > 0) {
+            const qasm_token& t = next();
+            if (t.kind == qasm_token::END) {
+                fail("unterminated gate body for '" + name + "'", t.line);
+            }
+            if (t.kind == qasm_token::SYMBOL && t.text == "{") {
+                ++depth;
+            } else if (t.kind == qasm_token::SYMBOL && t.text == "}") {
+                --depth;
+                if (depth == 0) {
+                    break;
+                }
+            }
+            def.body.push_back(t);
+        }
+        def.body.push_back(qasm_token());
+        gate_defs_[name] = def;
+    }
+
+    // Parameter expression: + - * / ^, unary minus, pi, numbers, gate parameters and functions
+    double expression(const std::map<std::string, double>& env) {
+        double value = term(env);
+        while (true) {
+            if (accept("+")) {
+                value += term(env);
+            } else if (accept("-")) {
+                value -= term(env);
+            } else {
+                return value;
+            }
+        }
+    }
+
+    double term(const std::map<std::string, double>& env) {
+        double value = power(env);
+        while (true) {
+            if (accept("*")) {
+                value *= power(env);
+            } else if (accept("/")) {
+                value /= power(env);
+            } else {
+                return value;
+            }
+        }
+    }
+
+    double power(const std::map<std::string, double>& env) {
+        double base = unary(env);
+        if (accept("^")) {
+            return std::pow(base, power(env));
+        }
+        return base;
+    }
+
+    double unary(const std::map<std::string, double>& env) {
+        if (accept("-")) {
+            return -unary(env);
+        }
+        if (accept("+")) {
+            return unary(env);
+        }
+        return primary(env);
+    }
+
+    double primary(const std::map<std::string, double>& env) {
+        const qasm_token& t = next();
+        if (t.kind == qasm_token::NUMBER) {
+            return t.number;
+        }
+        if (t.kind == qasm_token::SYMBOL && t.text == "(") {
+            double value = expression(env);
+            expect(")");
+            return value;
+        }
+        if (t.kind == qasm_token::IDENT) {
+            std::string name(t.text);
+            if (name == "pi") {
+                return M_PI;
+            }
+            auto param = env.find(name);
+            if (param != env.end()) {
+                return param->second;
+            }
+            if (accept("(")) {
+                double x = expression(env);
+                expect(")");
+                if (name == "sin") return std::sin(x);
+                if (name == "cos") return std::cos(x);
+                if (name == "tan") return std::tan(x);
+                if (name == "exp") return std::exp(x);
+                if (name == "ln") return std::log(x);
+                if (name == "sqrt") return std::sqrt(x);
+            }
+            fail("unknown identifier '" + name + "' in expression", t.line);
+        }
+        fail("unexpected '" + std::string(t.text) + "' in expression", t.line);
+    }
+
+    // Top-level gate call: arguments are register references with optional broadcasting
+    void gate_call_statement() {
+        int line = peek().line;
+        std::string name = identifier();
+        std::vector<double> params = parameter_list(std::map<std::string, double>());
+
+        std::vector<std::vector<int>> args;
+        size_t broadcast = 1;
+        do {
+            std::string reg = identifier();
+            auto it = qregs_.find(reg);
+            if (it == qregs_.end()) {
+                fail("unknown quantum register '" + reg + "'", line);
+            }
+            std::vector<int> qubits;
+            if (accept("[")) {
+                int index = integer();
+                expect("]");
+                if (index < 0 || index >= it->second.second) {
+                    fail("index out of range for register '" + reg + "'", line);
+                }
+                qubits.push_back(it->second.first + index);
+            } else {
+                for (int k = 0; k < it->second.second; ++k) {
+                    qubits.push_back(it->second.first + k);
+                }
+                broadcast = std::max(broadcast, qubits.size());
+            }
+            args.push_back(qubits);
+        } while (accept(","));
+        expect(";");
+
+        for (size_t b = 0; b < broadcast; ++b) {
+            std::vector<int> qubits;
+            for (const std::vector<int>& arg : args) {
+                if (arg.size() != 1 && arg.size() != broadcast) {
+                    fail("register size mismatch in '" + name + "'", line);
+                }
+                qubits.push_back(arg.size() == 1 ? arg[0] : arg[b]);
+            }
+            apply(name, params, qubits, line);
+        }
+    }
+
+    std::vector<double> parameter_list(const std::map<std::string, double>& env) {
+        std::vector<double> params;
+        if (accept("(")) {
+            if (!accept(")")) {
+                do {
+                    params.push_back(expression(env));
+                } while (accept(","));
+                expect(")");
+            }
+        }
+        return params;
+    }
+
+    // Function to apply a gate by name: native gates become gate list entries, defined gates
+    // are expanded recursively
+    void apply(const std::string& name, const std::vector<double>& params, const std::vector<int>& qubits, int line) {
+        qasm_matrix matrix;
+        if (qasm_native_matrix(name, params, matrix)) {
+            if (static_cast<int>(qubits.size()) != qasm_native_arity(matrix)) {
+                fail("wrong number of qubits for '" + name + "'", line);
+            }
+            if (qubits.size() == 2 && qubits[0] == qubits[1]) {
+                fail("repeated qubit argument for '" + name + "'", line);
+            }
+            emit(matrix, qubits);
+            return;
+        }
+
+        auto it = gate_defs_.find(name);
+        if (it == gate_defs_.end()) {
+            fail("unknown gate '" + name + "' or wrong number of parameters", line);
+        }
+        const qasm_gate_def& def = it->second;
+        if (def.params.size() != params.size() || def.args.size() != qubits.size()) {
+            fail("wrong number of parameters or qubits for '" + name + "'", line);
+        }
+
+        std::map<std::string, double> env;
+        for (size_t k = 0; k < params.size(); ++k) {
+            env[def.params[k]] = params[k];
+        }
+        std::map<std::string, int> bound;
+        for (size_t k = 0; k < qubits.size(); ++k) {
+            bound[def.args[k]] = qubits[k];
+        }
+
+        // Walk the body with a nested token stream
+        std::vector<qasm_token> saved_tokens = def.body;
+        saved_tokens.swap(tokens_);
+        size_t saved_pos = pos_;
+        pos_ = 0;
+
+        while (peek().kind != qasm_token::END) {
+            int body_line = peek().line;
+            std::string inner = identifier();
+            if (inner == "barrier") {
+                while (!accept(";")) {
+                    next();
+                }
+                continue;
+            }
+            std::vector<double> inner_params = parameter_list(env);
+            std::vector<int> inner_qubits;
+            do {
+                std::string arg = identifier();
+                auto q = bound.find(arg);
+                if (q == bound.end()) {
+                    fail("unknown argument '" + arg + "' in gate '" + name + "'", body_line);
+                }
+                inner_qubits.push_back(q->second);
+            } while (accept(","));
+            expect(";");
+            apply(inner, inner_params, inner_qubits, body_line);
+        }
+
+        tokens_.swap(saved_tokens);
+        pos_ = saved_pos;
+    }
+
+    void emit(const qasm_matrix& matrix, const std::vector<int>& qubits) {
+        gate_desc gate;
+        gate.control = (qubits.size() == 2) ? qubits[0] : -1;
+        gate.target = (qubits.size() == 2) ? qubits[1] : qubits[0];
+        gate.matrix = static_cast<int>(gates_.size());
+
+        size_t offset = gate_matrices_.size();
+        gate_matrices_.resize(offset + GATE_MATRIX_SIZE, make_amp(0.0f, 0.0f));
+        for (int k = 0; k < matrix.size * matrix.size; ++k) {
+            gate_matrices_[offset + k] = make_amp(static_cast<float>(matrix.m[k].real()), static_cast<float>(matrix.m[k].imag()));
+        }
+
+        classify_gate(gate, &gate_matrices_[offset]);
+        gates_.push_back(gate);
+    }
+};
+
+// Function to read an OpenQASM 2.0 file into the packed gate list and number of qubits
+inline void read_qasm(const std::string& filename, std::vector<gate_desc>& gates, std::vector<amp_t>& gate_matrices, int& num_qubits) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file");
+    }
+    std::string source;
+    file.seekg(0, std::ios::end);
+    source.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    file.read(&source[0], static_cast<std::streamsize>(source.size()));
+
+    qasm_parser parser(gates, gate_matrices);
+    parser.parse(source);
+    num_qubits = parser.num_qubits();
+}
+
+#endif
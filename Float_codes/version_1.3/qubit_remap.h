@@ -0,0 +1,199 @@
+#ifndef QUBIT_REMAP_H
+#define QUBIT_REMAP_H
+
+// Host-side qubit remapping: tracks a logical-to-physical qubit layout and inserts
+// GATE_PERMUTE passes (see gate_desc.h) that move the qubits of upcoming gates into the low
+// bit positions, where their amplitude pairs sit close together and the gates can be
+// grouped into tile blocks (gate_blocking.h).
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include "gate_desc.h"
+#include "gate_blocking.h"
+
+// Number of upcoming gates considered for one remap
+#define REMAP_LOOKAHEAD (4 * GATE_BLOCK_MAX_GATES)
+
+// Result of remap_qubits
+struct remap_stats {
+    size_t remaps;          // GATE_PERMUTE passes inserted, including the final restore
+    size_t passes_before;   // Passes over the state of the tiled gate list without remapping
+    size_t passes_after;    // Passes over the state with remapping
+};
+
+// Function to rewrite a gate's logical qubits to their physical positions
+inline gate_desc map_gate(const gate_desc& gate, const std::vector<int>& physical) {
+    gate_desc mapped = gate;
+    mapped.target = physical[gate.target];
+    if (gate.control >= 0) {
+        mapped.control = physical[gate.control];
+    }
+    return mapped;
+}
+
+// Function to count the passes over the state a gate list needs once tiled
+inline size_t tiled_passes(const std::vector<gate_desc>& gates, int tile_qubits) {
+    std::vector<gate_desc> blocked;
+    build_gate_blocks(gates.data(), gates.size(), tile_qubits, blocked);
+    return count_state_passes(blocked.data(), blocked.size());
+}
+
+// Function to append GATE_PERMUTE records exchanging the given pairs of physical positions
+// (GATE_MATRIX_SIZE pairs per record). Returns the number of records appended.
+inline size_t append_permute(std::vector<gate_desc>& gates, std::vector<amp_t>& gate_matrices,
+                             const std::vector<std::pair<int, int>>& pairs) {
+    size_t records = 0;
+    for (size_t first = 0; first < pairs.size(); first += GATE_MATRIX_SIZE) {
+        size_t count = std::min(pairs.size() - first, static_cast<size_t>(GATE_MATRIX_SIZE));
+
+        gate_desc gate;
+        gate.type = GATE_PERMUTE;
+        gate.control = static_cast<int>(count);
+        gate.target = 0;
+        gate.matrix = static_cast<int>(gate_matrices.size() / GATE_MATRIX_SIZE);
+        gates.push_back(gate);
+
+        gate_matrices.resize(gate_matrices.size() + GATE_MATRIX_SIZE, make_amp(0.0f, 0.0f));
+        amp_t* block = &gate_matrices[gate.matrix * GATE_MATRIX_SIZE];
+        for (size_t p = 0; p < count; ++p) {
+            block[p] = make_amp(static_cast<float>(pairs[first + p].first), static_cast<float>(pairs[first + p].second));
+        }
+        ++records;
+    }
+    return records;
+}
+
+// Function to remap qubits so that runs of gates fit into tiles of 2^tile_qubits amplitudes.
+// The gates are scanned in order; for each run of upcoming gates that touches at most
+// tile_qubits distinct qubits, the qubits of the run that sit at high physical positions are
+// exchanged with low positions the run does not use, if the permutation pass costs less than
+// the passes it saves. The layout is restored to the identity at the end of the circuit, so
+// the final state needs no host-side reordering. The gate list is left unchanged if
+// remapping does not reduce the total number of passes.
+inline remap_stats remap_qubits(std::vector<gate_desc>& gates, std::vector<amp_t>& gate_matrices,
+                                int num_qubits, int tile_qubits) {
+    std::vector<int> physical(num_qubits);  // Logical qubit -> physical bit position
+    std::vector<int> holder(num_qubits);    // Physical bit position -> logical qubit
+    for (int q = 0; q < num_qubits; ++q) {
+        physical[q] = q;
+        holder[q] = q;
+    }
+
+    // Exchange the logical qubits held at two physical positions
+    auto swap_positions = [&](int a, int b) {
+        std::swap(holder[a], holder[b]);
+        physical[holder[a]] = a;
+        physical[holder[b]] = b;
+    };
+
+    remap_stats stats = {0, tiled_passes(gates, tile_qubits), 0};
+    size_t original_pool_size = gate_matrices.size();
+    std::vector<gate_desc> remapped;
+    remapped.reserve(gates.size());
+
+    size_t i = 0;
+    while (i < gates.size()) {
+        // Longest upcoming run whose logical qubits fit in one tile
+        std::vector<bool> used(num_qubits, false);
+        int distinct = 0;
+        size_t end = i;
+        while (end < gates.size() && end - i < REMAP_LOOKAHEAD) {
+            const gate_desc& gate = gates[end];
+            int added = (used[gate.target] ? 0 : 1) + ((gate.control >= 0 && !used[gate.control]) ? 1 : 0);
+            if (distinct + added > tile_qubits) {
+                break;
+            }
+            used[gate.target] = true;
+            if (gate.control >= 0) {
+                used[gate.control] = true;
+            }
+            distinct += added;
+            ++end;
+        }
+
+        if (end - i < 2) {
+            remapped.push_back(map_gate(gates[i], physical));
+            ++i;
+            continue;
+        }
+
+        std::vector<gate_desc> run;
+        for (size_t k = i; k < end; ++k) {
+            run.push_back(map_gate(gates[k], physical));
+        }
+
+        // Pair every high qubit of the run with a low position the run does not use
+        std::vector<std::pair<int, int>> pairs;
+        int slot = 0;
+        for (int q = 0; q < num_qubits; ++q) {
+            if (!used[q] || physical[q] < tile_qubits) {
+                continue;
+            }
+            while (used[holder[slot]]) {
+                ++slot;
+            }
+            pairs.push_back(std::make_pair(slot, physical[q]));
+            ++slot;
+        }
+
+        if (!pairs.empty()) {
+            std::vector<int> saved_physical = physical;
+            std::vector<int> saved_holder = holder;
+            for (const auto& pair : pairs) {
+                swap_positions(pair.first, pair.second);
+            }
+
+            std::vector<gate_desc> moved_run;
+            for (size_t k = i; k < end; ++k) {
+                moved_run.push_back(map_gate(gates[k], physical));
+            }
+
+            size_t permute_passes = (pairs.size() + GATE_MATRIX_SIZE - 1) / GATE_MATRIX_SIZE;
+            if (permute_passes + tiled_passes(moved_run, tile_qubits) < tiled_passes(run, tile_qubits)) {
+                stats.remaps += append_permute(remapped, gate_matrices, pairs);
+                run.swap(moved_run);
+            } else {
+                physical.swap(saved_physical);
+                holder.swap(saved_holder);
+            }
+        }
+
+        remapped.insert(remapped.end(), run.begin(), run.end());
+        i = end;
+    }
+
+    // Restore the identity layout, one round of disjoint exchanges per pass
+    for (;;) {
+        std::vector<std::pair<int, int>> pairs;
+        std::vector<bool> busy(num_qubits, false);
+        for (int position = 0; position < num_qubits; ++position) {
+            int source = physical[position];  // Where logical qubit `position` currently sits
+            if (source == position || busy[position] || busy[source]) {
+                continue;
+            }
+            pairs.push_back(std::make_pair(position, source));
+            busy[position] = true;
+            busy[source] = true;
+            swap_positions(position, source);
+        }
+        if (pairs.empty()) {
+            break;
+        }
+        stats.remaps += append_permute(remapped, gate_matrices, pairs);
+    }
+
+    stats.passes_after = tiled_passes(remapped, tile_qubits);
+    if (stats.passes_after >= stats.passes_before) {
+        // Not worth it: keep the original list
+        gate_matrices.resize(original_pool_size);
+        stats.remaps = 0;
+        stats.passes_after = stats.passes_before;
+        return stats;
+    }
+
+    gates.swap(remapped);
+    return stats;
+}
+
+#endif
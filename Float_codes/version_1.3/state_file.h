@@ -0,0 +1,247 @@
+#ifndef STATE_FILE_H
+#define STATE_FILE_H
+
+// Final state vector output. The default is a raw binary file (.q2st): a small header
+// followed by the 2^n amplitudes exactly as they sit in the output buffer, written with
+// large pwrite calls straight from the mapped bo. The text format of the earlier versions
+// (one "re+imi" line per amplitude) is kept as an opt-in writer and conversion tool.
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "gate_desc.h"
+
+#define STATE_FILE_MAGIC "Q2SVSTAT"
+#define STATE_FILE_VERSION 1
+#define STATE_FILE_DATA_OFFSET 64
+
+// Amplitude encodings (interleaved real, imaginary)
+enum state_file_format {
+    STATE_COMPLEX64 = 0,    // 2 x IEEE float32
+    STATE_COMPLEX32 = 1,    // 2 x IEEE float16
+    STATE_BFLOAT16 = 2      // 2 x bfloat16
+};
+
+// Encoding of the compiled amp_t (amp_types.h). Fixed-point amplitudes have no encoding of
+// their own and are converted to complex64 while writing.
+#if defined(AMP_PRECISION_HALF)
+#define STATE_FILE_FORMAT STATE_COMPLEX32
+#elif defined(AMP_PRECISION_BFLOAT16)
+#define STATE_FILE_FORMAT STATE_BFLOAT16
+#else
+#define STATE_FILE_FORMAT STATE_COMPLEX64
+#endif
+
+struct state_file_header {
+    char magic[8];          // STATE_FILE_MAGIC, not null-terminated
+    uint32_t version;       // STATE_FILE_VERSION
+    uint32_t format;        // One of state_file_format
+    int32_t num_qubits;     // Number of qubits; the file holds 2^num_qubits amplitudes
+    uint32_t amp_size;      // Bytes per amplitude
+    uint64_t data_offset;   // Byte offset of the first amplitude
+};
+
+// Largest single pwrite; a full 30-qubit complex64 state is written in 8 calls
+static const size_t STATE_FILE_WRITE_CHUNK = size_t(1) << 30;
+
+// Function to write a buffer with pwrite, retrying short writes
+inline void pwrite_all(int fd, const char* data, size_t size, off_t offset) {
+    while (size > 0) {
+        size_t request = size < STATE_FILE_WRITE_CHUNK ? size : STATE_FILE_WRITE_CHUNK;
+        ssize_t written = ::pwrite(fd, data, request, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("pwrite failed: ") + std::strerror(errno));
+        }
+        data += written;
+        size -= written;
+        offset += written;
+    }
+}
+
+// Function to write the state vector as a binary state file. The state may be held in
+// num_chunks buffers of 2^num_qubits / num_chunks amplitudes each, in index order.
+inline void write_state_binary(const std::string& filename, const amp_t* const* chunks, int num_chunks, int num_qubits) {
+    state_file_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, STATE_FILE_MAGIC, sizeof(header.magic));
+    header.version = STATE_FILE_VERSION;
+    header.format = STATE_FILE_FORMAT;
+    header.num_qubits = num_qubits;
+    header.amp_size = (STATE_FILE_FORMAT == STATE_COMPLEX64) ? 8 : 4;
+    header.data_offset = STATE_FILE_DATA_OFFSET;
+
+    int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open " + filename + " for writing");
+    }
+    try {
+        char header_block[STATE_FILE_DATA_OFFSET] = {};
+        std::memcpy(header_block, &header, sizeof(header));
+        pwrite_all(fd, header_block, sizeof(header_block), 0);
+        size_t chunk_states = (size_t(1) << num_qubits) / num_chunks;
+        size_t chunk_bytes = chunk_states * header.amp_size;
+        for (int c = 0; c < num_chunks; ++c) {
+#if defined(AMP_PRECISION_FIXED)
+            // Convert through a bounded buffer
+            std::vector<std::complex<float>> converted(std::min(chunk_states, STATE_FILE_WRITE_CHUNK / 8));
+            for (size_t first = 0; first < chunk_states; first += converted.size()) {
+                size_t count = std::min(converted.size(), chunk_states - first);
+                for (size_t i = 0; i < count; ++i) {
+                    converted[i] = amp_to_float(chunks[c][first + i]);
+                }
+                pwrite_all(fd, reinterpret_cast<const char*>(converted.data()), count * 8,
+                           STATE_FILE_DATA_OFFSET + c * chunk_bytes + first * 8);
+            }
+#else
+            pwrite_all(fd, reinterpret_cast<const char*>(chunks[c]), chunk_bytes, STATE_FILE_DATA_OFFSET + c * chunk_bytes);
+#endif
+        }
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    if (::close(fd) != 0) {
+        throw std::runtime_error("Failed to write " + filename);
+    }
+}
+
+inline void write_state_binary(const std::string& filename, const amp_t* state, int num_qubits) {
+    write_state_binary(filename, &state, 1, num_qubits);
+}
+
+// Function to convert an IEEE float16 bit pattern to float
+inline float half_bits_to_float(uint16_t h) {
+    uint32_t sign = uint32_t(h & 0x8000) << 16;
+    int exponent = (h >> 10) & 0x1f;
+    uint32_t mantissa = h & 0x3ff;
+    uint32_t bits;
+    if (exponent == 0x1f) {
+        bits = sign | 0x7f800000 | (mantissa << 13);            // Inf / NaN
+    } else if (exponent != 0) {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);  // Normal
+    } else if (mantissa == 0) {
+        bits = sign;                                            // Zero
+    } else {
+        // Subnormal: renormalize the mantissa
+        exponent = 113;
+        while (!(mantissa & 0x400)) {
+            mantissa <<= 1;
+            --exponent;
+        }
+        bits = sign | (uint32_t(exponent) << 23) | ((mantissa & 0x3ff) << 13);
+    }
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// Function to convert a bfloat16 bit pattern to float
+inline float bfloat16_bits_to_float(uint16_t b) {
+    uint32_t bits = uint32_t(b) << 16;
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// Function to write the state vector in the text format of final_state_vector.csv, from
+// num_chunks buffers in index order
+inline void write_state_text(const std::string& filename, const amp_t* const* chunks, int num_chunks, int num_qubits) {
+    std::ofstream outFile(filename);
+    if (!outFile.is_open()) {
+        throw std::runtime_error("Failed to open " + filename + " for writing");
+    }
+    size_t chunk_states = (size_t(1) << num_qubits) / num_chunks;
+    for (int c = 0; c < num_chunks; ++c) {
+        const amp_t* state = chunks[c];
+        for (size_t i = 0; i < chunk_states; ++i) {
+            std::complex<float> amplitude = amp_to_float(state[i]);
+            outFile << amplitude.real() << "+" << amplitude.imag() << "i" << "\n";
+        }
+    }
+    outFile.close();
+    if (!outFile) {
+        throw std::runtime_error("Failed to write " + filename);
+    }
+}
+
+inline void write_state_text(const std::string& filename, const amp_t* state, int num_qubits) {
+    write_state_text(filename, &state, 1, num_qubits);
+}
+
+// Function to convert a binary state file to the text format
+inline void convert_state_to_text(const std::string& input, const std::string& output) {
+    int fd = ::open(input.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open " + input);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(state_file_header)) {
+        ::close(fd);
+        throw std::runtime_error("Not a state file (too short)");
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to mmap " + input);
+    }
+    ::madvise(mapping, size, MADV_SEQUENTIAL);
+
+    try {
+        const char* data = static_cast<const char*>(mapping);
+        state_file_header header;
+        std::memcpy(&header, data, sizeof(header));
+        size_t amp_size = (header.format == STATE_COMPLEX64) ? 8 : 4;
+        if (std::memcmp(header.magic, STATE_FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != STATE_FILE_VERSION) {
+            throw std::runtime_error("Not a state file (bad magic or version)");
+        }
+        if (header.format > STATE_BFLOAT16 || header.amp_size != amp_size ||
+            header.num_qubits < 0 || header.num_qubits > 40 ||
+            header.data_offset + (uint64_t(1) << header.num_qubits) * amp_size > size) {
+            throw std::runtime_error("Corrupt state file header");
+        }
+
+        std::ofstream outFile(output);
+        if (!outFile.is_open()) {
+            throw std::runtime_error("Failed to open " + output + " for writing");
+        }
+        const char* amps = data + header.data_offset;
+        size_t num_states = size_t(1) << header.num_qubits;
+        for (size_t i = 0; i < num_states; ++i) {
+            float re, im;
+            if (header.format == STATE_COMPLEX64) {
+                std::memcpy(&re, amps + i * 8, 4);
+                std::memcpy(&im, amps + i * 8 + 4, 4);
+            } else {
+                uint16_t h[2];
+                std::memcpy(h, amps + i * 4, 4);
+                re = (header.format == STATE_COMPLEX32) ? half_bits_to_float(h[0]) : bfloat16_bits_to_float(h[0]);
+                im = (header.format == STATE_COMPLEX32) ? half_bits_to_float(h[1]) : bfloat16_bits_to_float(h[1]);
+            }
+            outFile << re << "+" << im << "i" << "\n";
+        }
+        outFile.close();
+        if (!outFile) {
+            throw std::runtime_error("Failed to write " + output);
+        }
+    } catch (...) {
+        ::munmap(mapping, size);
+        throw;
+    }
+    ::munmap(mapping, size);
+}
+
+#endif
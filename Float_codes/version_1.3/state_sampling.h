@@ -0,0 +1,152 @@
+#ifndef STATE_SAMPLING_H
+#define STATE_SAMPLING_H
+
+// Measurement sampling shared by the vadd_sample kernel and the host (CPU backend, --stream,
+// --cus): draws shots from the final state without writing the state out.
+//
+// Pass 1 sums |amp|^2 over blocks of 2^SAMPLE_BLOCK_LOG2 amplitudes and stores the running
+// total after each block (block prefix sums, in double). Pass 2 draws the shots already
+// sorted, as exponential spacings: with E_1..E_{N+1} independent Exp(1) draws and S_k their
+// running sums, S_1/S_{N+1} < ... < S_N/S_{N+1} are N sorted uniform draws. Sorted
+// thresholds walk the state once, left to right: the prefix sums skip every block below the
+// next threshold, and only blocks that hold a shot are read again. The random numbers are
+// splitmix64, so a seed gives the same shots on the device and on the host.
+//
+// Results are (index, count) records in index order, one per distinct outcome; bit q of
+// index is qubit q.
+
+#include "gate_desc.h"
+#include <cmath>
+
+// log2 of the amplitudes per prefix sum block
+#define SAMPLE_BLOCK_LOG2 10
+
+// Independent partial sums per block, so the float additions of pass 1 pipeline
+#define SAMPLE_PARTIAL_SUMS 8
+
+// One distinct outcome and how many shots gave it
+struct shot_count {
+    long long index;    // Basis state, bit q = qubit q
+    long long count;    // Shots that measured it
+};
+
+// splitmix64 random numbers for the shot thresholds
+struct sample_rng {
+    unsigned long long state;
+
+    unsigned long long next() {
+        unsigned long long z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    // Exp(1) draw, -log of a uniform in (0, 1]
+    double exponential() {
+        double u = ((next() >> 11) + 1) * (1.0 / 9007199254740992.0);
+        return -std::log(u);
+    }
+};
+
+// Function to get |a|^2 in float
+inline float sample_probability(const amp_t &a) {
+    float re = static_cast<float>(a.real());
+    float im = static_cast<float>(a.imag());
+    return re * re + im * im;
+}
+
+// Function to compute the block prefix sums of |amp|^2 (pass 1). block_prefix receives
+// 2^(num_qubits - block_log2) entries; returns the total probability.
+template <typename state_view>
+inline double sample_block_prefix(const state_view &state, int num_qubits, double *block_prefix) {
+    const int block_log2 = (num_qubits < SAMPLE_BLOCK_LOG2) ? num_qubits : SAMPLE_BLOCK_LOG2;
+    const long long num_blocks = 1LL << (num_qubits - block_log2);
+    const long long block_size = 1LL << block_log2;
+
+    double total = 0.0;
+    HLS_LABEL(block_loop) for (long long b = 0; b < num_blocks; ++b) {
+        float partial[SAMPLE_PARTIAL_SUMS];
+        HLS_PRAGMA(HLS ARRAY_PARTITION variable=partial complete)
+        for (int k = 0; k < SAMPLE_PARTIAL_SUMS; ++k) {
+            HLS_PRAGMA(HLS UNROLL)
+            partial[k] = 0.0f;
+        }
+        HLS_LABEL(sum_loop) for (long long i = 0; i < block_size; ++i) {
+            HLS_PRAGMA(HLS PIPELINE II=1)
+            HLS_PRAGMA(HLS DEPENDENCE variable=partial inter false)
+            partial[i % SAMPLE_PARTIAL_SUMS] += sample_probability(state[(b << block_log2) + i]);
+        }
+        float block_sum = 0.0f;
+        for (int k = 0; k < SAMPLE_PARTIAL_SUMS; ++k) {
+            block_sum += partial[k];
+        }
+        total += block_sum;
+        block_prefix[b] = total;
+    }
+    return total;
+}
+
+// Function to draw num_shots shots (pass 2) into results[0..], one record per distinct
+// outcome in index order; returns the number of records. The last amplitude of a block
+// takes the rounding difference between its block sum and the walk's running sum.
+template <typename state_view>
+inline long long sample_shots(const state_view &state, int num_qubits, const double *block_prefix, double total,
+                              long long num_shots, unsigned long long seed, shot_count *results) {
+    const int block_log2 = (num_qubits < SAMPLE_BLOCK_LOG2) ? num_qubits : SAMPLE_BLOCK_LOG2;
+    const long long last_block = (1LL << (num_qubits - block_log2)) - 1;
+    const long long block_mask = (1LL << block_log2) - 1;
+
+    // S_{N+1}, the scale of the thresholds, then the same draws again from the start
+    sample_rng rng = {seed};
+    double scale = 0.0;
+    HLS_LABEL(scale_loop) for (long long k = 0; k <= num_shots; ++k) {
+        scale += rng.exponential();
+    }
+    rng.state = seed;
+
+    long long index = 0;        // Current amplitude of the walk
+    long long block = 0;        // Its block
+    double below = 0.0;         // Probability of the amplitudes before index
+    double spacing = 0.0;       // S_k
+    long long num_records = 0;
+    long long current = -1;     // Outcome being counted
+    long long count = 0;
+    HLS_LABEL(shot_loop) for (long long k = 0; k < num_shots; ++k) {
+        spacing += rng.exponential();
+        double threshold = spacing / scale * total;
+
+        // Skip whole blocks that end at or below the threshold
+        while (block < last_block && block_prefix[block] <= threshold) {
+            below = block_prefix[block];
+            ++block;
+            index = block << block_log2;
+        }
+        // Walk the block up to the amplitude whose probability interval holds the threshold
+        while (true) {
+            double p = sample_probability(state[index]);
+            if (below + p > threshold || (index & block_mask) == block_mask) {
+                break;
+            }
+            below += p;
+            ++index;
+        }
+
+        if (index != current) {
+            if (count > 0) {
+                results[num_records].index = current;
+                results[num_records].count = count;
+                ++num_records;
+            }
+            current = index;
+            count = 0;
+        }
+        ++count;
+    }
+    if (count > 0) {
+        results[num_records].index = current;
+        results[num_records].count = count;
+        ++num_records;
+    }
+    return num_records;
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef STATE_SLICES_H
+#define STATE_SLICES_H
+
+// Host-side planning for running one gate list on several vadd compute units, each holding
+// a contiguous slice of the state in its own DDR bank. With 2^s slices, the top s physical
+// bit positions ("global" positions) select the slice and the remaining local positions
+// index inside it. A gate whose qubits are all local is applied by every CU to its own
+// slice concurrently; the rest are either reduced to a per-slice local gate (diagonal gates,
+// controls on a global qubit) or need an exchange that swaps a global position with a local
+// one (see run_fpga_multi_cu in host.cpp).
+
+#include <vector>
+#include <utility>
+#include "gate_desc.h"
+
+// Largest number of compute units (one per DDR bank on the U200)
+#define SLICE_MAX_CUS 4
+
+// True if the gate cannot be reduced to a slice-local gate while this physical position
+// is global: the target of every non-diagonal gate and both qubits of a general 4x4 must
+// be local. Controls of GATE_CX/GATE_CONTROLLED and the qubits of diagonal gates may stay global.
+inline bool slice_needs_local(const gate_desc& gate, int position, int local_qubits) {
+    if (position < local_qubits || gate.type == GATE_DIAGONAL) {
+        return false;
+    }
+    return position == gate.target || gate.type == GATE_TWO_QUBIT;
+}
+
+// Function to reduce a gate on physical positions to the gate slice `slice` applies to its
+// local amplitudes. Writes the local descriptor and its GATE_MATRIX_SIZE matrix entries and
+// returns false if the gate leaves this slice unchanged (control on a global qubit that is 0
+// here). The gate must not need an exchange (slice_needs_local is false for its qubits).
+inline bool slice_gate(const gate_desc& gate, const amp_t* matrix, int slice, int local_qubits,
+                       gate_desc& local_gate, amp_t* local_matrix) {
+    local_gate = gate;
+    for (int e = 0; e < GATE_MATRIX_SIZE; ++e) {
+        local_matrix[e] = matrix[e];
+    }
+    bool target_global = gate.target >= local_qubits;
+    bool control_global = gate.control >= local_qubits;
+    if (gate.type == GATE_PERMUTE || (!target_global && !control_global)) {
+        return true;  // GATE_PERMUTE records passed here only exchange local positions
+    }
+
+    if (gate.type == GATE_DIAGONAL) {
+        // The global bits are fixed within a slice, so the phases of the other qubit (or a
+        // single global phase) are selected here. A global phase is applied as a diagonal
+        // with two equal entries on local position 0.
+        int t = target_global ? (slice >> (gate.target - local_qubits)) & 1 : -1;
+        int c = control_global ? (slice >> (gate.control - local_qubits)) & 1 : -1;
+        amp_t d0, d1;
+        if (gate.control == -1) {
+            d0 = d1 = matrix[t];
+            local_gate.target = 0;
+        } else if (target_global && control_global) {
+            d0 = d1 = matrix[(t << 1) | c];
+            local_gate.target = 0;
+        } else if (target_global) {
+            d0 = matrix[t << 1];
+            d1 = matrix[(t << 1) | 1];
+            local_gate.target = gate.control;
+        } else {
+            d0 = matrix[c];
+            d1 = matrix[2 | c];
+        }
+        local_gate.control = -1;
+        for (int e = 0; e < GATE_MATRIX_SIZE; ++e) {
+            local_matrix[e] = make_amp(0.0f, 0.0f);
+        }
+        local_matrix[0] = d0;
+        local_matrix[1] = d1;
+        return true;
+    }
+
+    // Controlled gate with a global control and a local target: a 2x2 on the target in the
+    // slices where the control bit is 1, nothing elsewhere
+    if ((slice >> (gate.control - local_qubits) & 1) == 0) {
+        return false;
+    }
+    if (gate.type == GATE_CX) {
+        for (int e = 0; e < GATE_MATRIX_SIZE; ++e) {
+            local_matrix[e] = make_amp(0.0f, 0.0f);
+        }
+        local_matrix[1] = make_amp(1.0f, 0.0f);
+        local_matrix[2] = make_amp(1.0f, 0.0f);
+    }
+    local_gate.type = GATE_SINGLE;
+    local_gate.control = -1;
+    return true;
+}
+
+// Function to collect the disjoint exchange rounds that return a purely local layout
+// permutation to the identity (the global positions must already hold their own qubits).
+// Each round is a list of position pairs for one GATE_PERMUTE pass on every slice.
+inline std::vector<std::vector<std::pair<int, int>>> slice_restore_rounds(std::vector<int> physical) {
+    std::vector<std::vector<std::pair<int, int>>> rounds;
+    const int num_qubits = static_cast<int>(physical.size());
+    std::vector<int> holder(num_qubits);
+    for (int q = 0; q < num_qubits; ++q) {
+        holder[physical[q]] = q;
+    }
+    for (;;) {
+        std::vector<std::pair<int, int>> pairs;
+        std::vector<bool> busy(num_qubits, false);
+        for (int position = 0; position < num_qubits; ++position) {
+            int source = physical[position];
+            if (source == position || busy[position] || busy[source]) {
+                continue;
+            }
+            pairs.push_back(std::make_pair(position, source));
+            busy[position] = true;
+            busy[source] = true;
+            std::swap(holder[position], holder[source]);
+            physical[holder[position]] = position;
+            physical[holder[source]] = source;
+        }
+        if (pairs.empty()) {
+            break;
+        }
+        rounds.push_back(pairs);
+    }
+    return rounds;
+}
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef STREAM_BATCHES_H
+#define STREAM_BATCHES_H
+
+// Host-side planning for the out-of-core streaming mode (--stream): the state stays in host
+// memory and the device works on chunks of 2^chunk_qubits amplitudes at a time.
+//
+// The gate list is cut into batches of consecutive gates. Within a batch, qubits below
+// local_qubits stay in place, and up to STREAM_MAX_SELECT "select" qubits at or above it
+// pick which runs of 2^local_qubits consecutive host amplitudes are gathered into one
+// device chunk: run r of a chunk is the host run whose select bits equal r, and it lands
+// at chunk offset r << local_qubits, so select qubit k becomes chunk position
+// local_qubits + k. The remaining high qubits number the chunks. Every gate of the batch
+// then acts inside each chunk, and each chunk crosses PCIe once per batch.
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "gate_desc.h"
+
+// Largest number of select qubits per batch (runs gathered into one chunk = 2^this)
+#define STREAM_MAX_SELECT 2
+
+struct stream_batch {
+    size_t first;                   // Index of the first gate of the batch
+    size_t count;                   // Number of consecutive gates
+    int local_qubits;               // chunk_qubits minus the number of select qubits
+    std::vector<int> select;        // Select qubits, ascending
+    std::vector<int> chunk_bits;    // Qubits enumerated by the chunk index, ascending
+};
+
+// Function to find the fewest select qubits for a set of used qubits: the smallest h such
+// that at most h used qubits lie at or above chunk_qubits - h. Returns -1 if none fits.
+inline int stream_select_count(const std::vector<bool>& used, int num_qubits, int chunk_qubits) {
+    for (int h = 0; h <= STREAM_MAX_SELECT && h <= chunk_qubits; ++h) {
+        int high = 0;
+        for (int q = chunk_qubits - h; q < num_qubits; ++q) {
+            high += used[q] ? 1 : 0;
+        }
+        if (high <= h) {
+            return h;
+        }
+    }
+    return -1;
+}
+
+// Function to cut the gate list into batches, each as long as its qubits allow
+inline std::vector<stream_batch> plan_stream_batches(const gate_desc* gates, size_t num_gates,
+                                                     int num_qubits, int chunk_qubits) {
+    std::vector<stream_batch> batches;
+    size_t i = 0;
+    while (i < num_gates) {
+        std::vector<bool> used(num_qubits, false);
+        int select_count = 0;
+        size_t end = i;
+        while (end < num_gates) {
+            std::vector<bool> candidate = used;
+            candidate[gates[end].target] = true;
+            if (gates[end].control >= 0) {
+                candidate[gates[end].control] = true;
+            }
+            int h = stream_select_count(candidate, num_qubits, chunk_qubits);
+            if (h < 0) {
+                break;
+            }
+            used.swap(candidate);
+            select_count = h;
+            ++end;
+        }
+
+        stream_batch batch;
+        batch.first = i;
+        batch.count = end - i;
+        batch.local_qubits = chunk_qubits - select_count;
+
+        // Used high qubits are select qubits; pad with the highest unused ones
+        for (int q = batch.local_qubits; q < num_qubits; ++q) {
+            if (used[q]) {
+                batch.select.push_back(q);
+            }
+        }
+        for (int q = num_qubits - 1; static_cast<int>(batch.select.size()) < select_count; --q) {
+            if (!used[q]) {
+                batch.select.push_back(q);
+            }
+        }
+        std::sort(batch.select.begin(), batch.select.end());
+        for (int q = batch.local_qubits; q < num_qubits; ++q) {
+            if (!std::binary_search(batch.select.begin(), batch.select.end(), q)) {
+                batch.chunk_bits.push_back(q);
+            }
+        }
+        batches.push_back(batch);
+        i = end;
+    }
+    return batches;
+}
+
+// Function to rewrite a gate of a batch to its chunk positions
+inline gate_desc stream_map_gate(const gate_desc& gate, const stream_batch& batch) {
+    auto position = [&](int q) {
+        if (q < batch.local_qubits) {
+            return q;
+        }
+        return batch.local_qubits + static_cast<int>(std::lower_bound(batch.select.begin(), batch.select.end(), q) -
+                                                     batch.select.begin());
+    };
+    gate_desc mapped = gate;
+    mapped.target = position(gate.target);
+    if (gate.control >= 0) {
+        mapped.control = position(gate.control);
+    }
+    return mapped;
+}
+
+// Function to compute the host index of the first amplitude of run r of chunk j
+inline uint64_t stream_run_base(const stream_batch& batch, uint64_t chunk, uint64_t run) {
+    uint64_t base = 0;
+    for (size_t k = 0; k < batch.chunk_bits.size(); ++k) {
+        base |= ((chunk >> k) & 1) << batch.chunk_bits[k];
+    }
+    for (size_t k = 0; k < batch.select.size(); ++k) {
+        base |= ((run >> k) & 1) << batch.select[k];
+    }
+    return base;
+}
+
+#endif
@@ -0,0 +1,1111 @@
+#include <ap_int.h>
+#include "gate_desc.h"
+#include "state_sampling.h"
+#include "pauli_expectation.h"
+
+// Insert a zero bit at position pos of k
+static inline int insert_zero_bit(int k, int pos) {
+    return ((k >> pos) << (pos + 1)) | (k & ((1 << pos) - 1));
+}
+
+#ifdef AMP_LAYOUT_SOA
+// Planar views of a vadd state buffer (amp_types.h): the real plane followed by the
+// imaginary plane. Indexing a view reads or writes both parts of one amplitude, so the gate
+// loops below are the same code for both layouts.
+struct soa_const_state {
+    const amp_scalar_t *re;
+    const amp_scalar_t *im;
+    amp_t operator[](int i) const { return amp_t(re[i], im[i]); }
+};
+
+struct soa_ref {
+    amp_scalar_t *re;
+    amp_scalar_t *im;
+    operator amp_t() const { return amp_t(*re, *im); }
+    soa_ref &operator=(const amp_t &value) {
+        *re = value.real();
+        *im = value.imag();
+        return *this;
+    }
+};
+
+struct soa_state {
+    amp_scalar_t *re;
+    amp_scalar_t *im;
+    soa_ref operator[](int i) const {
+        soa_ref ref = {re + i, im + i};
+        return ref;
+    }
+};
+#endif
+
+// Apply a diagonal gate: one sequential read, one complex multiply by the phase selected
+// from the index bits and one write per amplitude. Each amplitude depends only on itself,
+// so state_vector and output_state_vector may be the same buffer (in-place update).
+// The state arguments are amp_t pointers or, for vadd with AMP_LAYOUT_SOA, planar views.
+template <typename state_in, typename state_out>
+static void apply_diagonal(
+    state_in state_vector,             // Input complex state vector
+    const amp_t *diagonal,             // Diagonal entries (2 for single-qubit, 4 for two-qubit)
+    state_out output_state_vector,     // Output complex state vector (may alias state_vector)
+    int control,                       // Control qubit index (-1 for single-qubit gates)
+    int target,                        // Target qubit index
+    int num_qubits                     // Number of qubits
+) {
+    int num_states = 1 << num_qubits; // Total states (2^num_qubits)
+
+    // Phases held in registers for the whole pass
+    amp_t d[4];
+    #pragma HLS ARRAY_PARTITION variable=d complete
+    diagonal_load_loop: for (int e = 0; e < 4; ++e) {
+        #pragma HLS PIPELINE II=1
+        d[e] = (e < gate_matrix_entries(GATE_DIAGONAL, control)) ? diagonal[e] : make_amp(0.0f, 0.0f);
+    }
+
+    diagonal_loop: for (int i = 0; i < num_states; ++i) {
+        #pragma HLS PIPELINE II=1
+
+        int bit = (i >> target) & 1;
+        int select = (control == -1) ? bit : ((bit << 1) | ((i >> control) & 1));
+        output_state_vector[i] = d[select] * state_vector[i];
+    }
+}
+
+// Apply one gate to state_vector and write the result to output_state_vector (amp_t
+// pointers or planar views, as for apply_diagonal)
+template <typename state_in, typename state_out>
+static void apply_gate(
+    state_in state_vector,             // Input complex state vector
+    const amp_t *gate_matrix,          // Gate matrix (2x2 for single-qubit, 4x4 for two-qubit)
+    state_out output_state_vector,     // Output complex state vector
+    int type,                          // Gate kind (gate_type)
+    int control,                       // Control qubit index (-1 for no control)
+    int target,                        // Target qubit index
+    int num_qubits                     // Number of qubits
+) {
+    int num_states = 1 << num_qubits; // Total states (2^num_qubits)
+
+    if (type == GATE_DIAGONAL) {
+        apply_diagonal(state_vector, gate_matrix, output_state_vector, control, target, num_qubits);
+        return;
+    }
+
+    // Load the entries the gate uses into registers once, instead of reading gate_matrix
+    // from DDR for every amplitude
+    amp_t m[GATE_MATRIX_SIZE];
+    #pragma HLS ARRAY_PARTITION variable=m complete
+    const int entries = gate_matrix_entries(type, control);
+    matrix_load_loop: for (int e = 0; e < GATE_MATRIX_SIZE; ++e) {
+        #pragma HLS PIPELINE II=1
+        m[e] = (e < entries) ? gate_matrix[e] : make_amp(0.0f, 0.0f);
+    }
+
+    if (type == GATE_SINGLE) {
+        single_qubit_loop: for (int i = 0; i < num_states; ++i) {
+            #pragma HLS PIPELINE II=1
+
+            // Get the bit at the target position.
+            int bit = (i >> target) & 1;
+            // Compute the partner index by flipping the target bit.
+            int partner = i ^ (1 << target);
+
+            if (bit == 0) {
+                // When the target bit is 0, i is the lower index.
+                output_state_vector[i] = m[0] * state_vector[i] +
+                                         m[1] * state_vector[partner];
+            }
+            else {
+                // When the target bit is 1, i is the higher index.
+                output_state_vector[i] = m[2] * state_vector[partner] +
+                                         m[3] * state_vector[i];
+            }
+        }
+    }
+    // Controlled 2x2 operation: only the control=1 quarter of the 4x4 matrix is applied
+    else if (type == GATE_CONTROLLED) {
+        controlled_loop: for (int i = 0; i < num_states; ++i) {
+            #pragma HLS PIPELINE II=1
+
+            int control_bit = (i >> control) & 1;
+            int bit = (i >> target) & 1;
+            int partner = i ^ (1 << target);
+
+            if (control_bit == 0) {
+                // Control not set: the amplitude passes through unchanged
+                output_state_vector[i] = state_vector[i];
+            }
+            else if (bit == 0) {
+                output_state_vector[i] = m[0] * state_vector[i] +
+                                         m[1] * state_vector[partner];
+            }
+            else {
+                output_state_vector[i] = m[2] * state_vector[partner] +
+                                         m[3] * state_vector[i];
+            }
+        }
+    }
+    // General two-qubit operation with the full 4x4 matrix
+    else if (type == GATE_TWO_QUBIT) {
+        const int low = (control < target) ? control : target;
+        const int high = (control < target) ? target : control;
+
+        // Each iteration handles the four amplitudes that differ only in the control and target bits
+        two_qubit_matrix_loop: for (int k = 0; k < (num_states >> 2); ++k) {
+            #pragma HLS PIPELINE II=1
+
+            int base = insert_zero_bit(insert_zero_bit(k, low), high);
+            int idx[4];
+            amp_t in[4];
+            for (int l = 0; l < 4; ++l) {
+                // Local index bit 0 is the control qubit, bit 1 the target qubit
+                idx[l] = base | ((l & 1) << control) | ((l >> 1) << target);
+                in[l] = state_vector[idx[l]];
+            }
+            for (int row = 0; row < 4; ++row) {
+                output_state_vector[idx[row]] = m[row * 4 + 0] * in[0] +
+                                                m[row * 4 + 1] * in[1] +
+                                                m[row * 4 + 2] * in[2] +
+                                                m[row * 4 + 3] * in[3];
+            }
+        }
+    }
+    // Bit permutation: output amplitude i is read from i with each listed pair of bits exchanged
+    else if (type == GATE_PERMUTE) {
+        int first[GATE_MATRIX_SIZE];
+        int second[GATE_MATRIX_SIZE];
+        for (int p = 0; p < GATE_MATRIX_SIZE; ++p) {
+            first[p] = (p < control) ? static_cast<int>(m[p].real()) : 0;
+            second[p] = (p < control) ? static_cast<int>(m[p].imag()) : 0;
+        }
+
+        permute_loop: for (int i = 0; i < num_states; ++i) {
+            #pragma HLS PIPELINE II=1
+            int source = i;
+            for (int p = 0; p < GATE_MATRIX_SIZE; ++p) {
+                // Pairs are disjoint, so every exchange can be decided from the bits of i
+                if (p < control && (((i >> first[p]) ^ (i >> second[p])) & 1)) {
+                    source ^= (1 << first[p]) | (1 << second[p]);
+                }
+            }
+            output_state_vector[i] = state_vector[source];
+        }
+    }
+    // Controlled-X operation
+    else {
+        // Initialize output_state_vector to be a copy of the original state_vector
+        copy_loop: for (int i = 0; i < num_states; ++i) {
+            #pragma HLS PIPELINE II=1
+            #pragma HLS UNROLL factor=6
+            output_state_vector[i] = state_vector[i];
+        }
+
+        // Loop over blocks of indices with the control bit set.
+        two_qubit_loop: for (int i = (1 << control); i < num_states; i += (1 << (control + 1))) {
+            #pragma HLS PIPELINE II=1
+
+            // Each block covers a contiguous range of size (1 << control).
+            const int block_start = i;
+            const int block_end   = i + (1 << control);
+
+            if (target >= control) {
+                // The target bit is constant over the entire block.
+                if ((block_start & (1 << target)) == 0) {
+                    for (int idx = block_start; idx < block_end; idx++) {
+                        int flipped_idx = idx ^ (1 << target);
+                        amp_t temp = output_state_vector[idx];
+                        output_state_vector[idx] = state_vector[flipped_idx];
+                        output_state_vector[flipped_idx] = temp;
+                    }
+                }
+            }
+            else {
+                // The block spans several periods of the target bit.
+                // In each period of length 'period', the first half have target bit 0.
+                const int period = 1 << (target + 1);
+                const int half_period = 1 << target;
+                int idx = block_start;
+                while (idx < block_end) {
+                    int offset = idx & (period - 1);
+                    if (offset < half_period) {
+                        // idx has target bit 0; perform the swap.
+                        int flipped_idx = idx ^ (1 << target);
+                        amp_t temp = output_state_vector[idx];
+                        output_state_vector[idx] = state_vector[flipped_idx];
+                        output_state_vector[flipped_idx] = temp;
+                        idx++;
+                    }
+                    else {
+                        // Skip the remainder of this period (indices where target bit is 1)
+                        idx += (period - offset);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Apply one gate in place to a tile held in on-chip memory. Each iteration reads the
+// amplitudes it updates (a pair, or four for two-qubit gates) before writing them back.
+static void apply_tile_gate(
+    amp_t *tile,                       // Tile of 2^tile_qubits amplitudes (updated in place)
+    const amp_t *gate_matrix,          // Gate matrix or diagonal
+    int type,                          // Gate kind (gate_type)
+    int control,                       // Control qubit index (-1 for no control)
+    int target,                        // Target qubit index
+    int tile_qubits                    // Number of qubits covered by the tile
+) {
+    int tile_size = 1 << tile_qubits;
+
+    if (type == GATE_DIAGONAL) {
+        tile_diagonal_loop: for (int i = 0; i < tile_size; ++i) {
+            #pragma HLS PIPELINE II=1
+            int bit = (i >> target) & 1;
+            int select = (control == -1) ? bit : ((bit << 1) | ((i >> control) & 1));
+            tile[i] = gate_matrix[select] * tile[i];
+        }
+    }
+    else if (type == GATE_SINGLE) {
+        tile_single_loop: for (int k = 0; k < (tile_size >> 1); ++k) {
+            #pragma HLS PIPELINE II=1
+            int i0 = insert_zero_bit(k, target);
+            int i1 = i0 | (1 << target);
+            amp_t a0 = tile[i0];
+            amp_t a1 = tile[i1];
+            tile[i0] = gate_matrix[0] * a0 + gate_matrix[1] * a1;
+            tile[i1] = gate_matrix[2] * a0 + gate_matrix[3] * a1;
+        }
+    }
+    else if (type == GATE_CX || type == GATE_CONTROLLED) {
+        const int low = (control < target) ? control : target;
+        const int high = (control < target) ? target : control;
+
+        tile_controlled_loop: for (int k = 0; k < (tile_size >> 2); ++k) {
+            #pragma HLS PIPELINE II=1
+            int i0 = insert_zero_bit(insert_zero_bit(k, low), high) | (1 << control);
+            int i1 = i0 | (1 << target);
+            amp_t a0 = tile[i0];
+            amp_t a1 = tile[i1];
+            if (type == GATE_CX) {
+                tile[i0] = a1;
+                tile[i1] = a0;
+            }
+            else {
+                tile[i0] = gate_matrix[0] * a0 + gate_matrix[1] * a1;
+                tile[i1] = gate_matrix[2] * a0 + gate_matrix[3] * a1;
+            }
+        }
+    }
+    else {
+        const int low = (control < target) ? control : target;
+        const int high = (control < target) ? target : control;
+
+        tile_two_qubit_loop: for (int k = 0; k < (tile_size >> 2); ++k) {
+            #pragma HLS PIPELINE II=1
+            int base = insert_zero_bit(insert_zero_bit(k, low), high);
+            int idx[4];
+            amp_t in[4];
+            for (int l = 0; l < 4; ++l) {
+                idx[l] = base | ((l & 1) << control) | ((l >> 1) << target);
+                in[l] = tile[idx[l]];
+            }
+            for (int row = 0; row < 4; ++row) {
+                tile[idx[row]] = gate_matrix[row * 4 + 0] * in[0] +
+                                 gate_matrix[row * 4 + 1] * in[1] +
+                                 gate_matrix[row * 4 + 2] * in[2] +
+                                 gate_matrix[row * 4 + 3] * in[3];
+            }
+        }
+    }
+}
+
+// Apply a GATE_BLOCK in place: the block's gates and matrices are cached on chip, then each
+// tile of the state is read once, run through every gate of the block and written back.
+static void apply_block(
+    amp_t *state,                      // State buffer (updated in place)
+    const gate_desc *block_gates,      // The block_size gate records following the header
+    const amp_t *gate_matrices,        // Matrix pool
+    int block_size,                    // Number of gates in the block
+    int tile_qubits,                   // Tile size in qubits
+    int num_qubits                     // Number of qubits
+) {
+    amp_t tile[1 << GATE_TILE_MAX_QUBITS];
+    gate_desc gates[GATE_BLOCK_MAX_GATES];
+    amp_t matrices[GATE_BLOCK_MAX_GATES][GATE_MATRIX_SIZE];
+#pragma HLS BIND_STORAGE variable=tile type=ram_2p impl=bram
+#pragma HLS ARRAY_PARTITION variable=matrices dim=2 complete
+
+    block_load_loop: for (int b = 0; b < block_size; ++b) {
+        gates[b] = block_gates[b];
+        for (int e = 0; e < GATE_MATRIX_SIZE; ++e) {
+            #pragma HLS PIPELINE II=1
+            matrices[b][e] = gate_matrices[gates[b].matrix * GATE_MATRIX_SIZE + e];
+        }
+    }
+
+    const int tile_size = 1 << tile_qubits;
+    const int num_tiles = 1 << (num_qubits - tile_qubits);
+
+    tile_loop: for (int t = 0; t < num_tiles; ++t) {
+        amp_t *tile_state = state + t * tile_size;
+
+        tile_read_loop: for (int i = 0; i < tile_size; ++i) {
+            #pragma HLS PIPELINE II=1
+            tile[i] = tile_state[i];
+        }
+
+        tile_gate_loop: for (int b = 0; b < block_size; ++b) {
+            apply_tile_gate(tile, matrices[b], gates[b].type, gates[b].control, gates[b].target, tile_qubits);
+        }
+
+        tile_write_loop: for (int i = 0; i < tile_size; ++i) {
+            #pragma HLS PIPELINE II=1
+            tile_state[i] = tile[i];
+        }
+    }
+}
+
+// Index into the state of the chunked kernels: 64 bits, so states of 2^31 amplitudes and
+// more (31 to 33 qubits) can be addressed
+typedef long long index_t;
+
+// Insert a zero bit at position pos of a 64-bit index
+static inline index_t insert_zero_bit64(index_t k, int pos) {
+    return ((k >> pos) << (pos + 1)) | (k & ((index_t(1) << pos) - 1));
+}
+
+// Read amplitude `index` of a state split into chunks of 2^chunk_qubits amplitudes; the
+// top index bits select the chunk pointer
+static inline amp_t read_chunked(
+    const amp_t *chunk0, const amp_t *chunk1, const amp_t *chunk2, const amp_t *chunk3,
+    index_t index, int chunk_qubits
+) {
+#pragma HLS INLINE
+    int chunk = index >> chunk_qubits;
+    index_t offset = index & ((index_t(1) << chunk_qubits) - 1);
+    switch (chunk) {
+    case 0: return chunk0[offset];
+    case 1: return chunk1[offset];
+    case 2: return chunk2[offset];
+    default: return chunk3[offset];
+    }
+}
+
+// Write amplitude `index` of a chunked state
+static inline void write_chunked(
+    amp_t *chunk0, amp_t *chunk1, amp_t *chunk2, amp_t *chunk3,
+    index_t index, int chunk_qubits, const amp_t &value
+) {
+#pragma HLS INLINE
+    int chunk = index >> chunk_qubits;
+    index_t offset = index & ((index_t(1) << chunk_qubits) - 1);
+    switch (chunk) {
+    case 0: chunk0[offset] = value; break;
+    case 1: chunk1[offset] = value; break;
+    case 2: chunk2[offset] = value; break;
+    default: chunk3[offset] = value; break;
+    }
+}
+
+// Read-only view of a state held in chunks of 2^chunk_qubits amplitudes on the four chunk
+// ports of vadd_sample, chunk j on port (first_port + j) % 4, so a single state buffer can
+// sit behind whichever port is connected to its bank
+struct port_chunks_view {
+    const amp_t *port0;
+    const amp_t *port1;
+    const amp_t *port2;
+    const amp_t *port3;
+    int chunk_qubits;
+    int first_port;
+
+    amp_t operator[](index_t index) const {
+#pragma HLS INLINE
+        int port = ((index >> chunk_qubits) + first_port) & 3;
+        index_t offset = index & ((index_t(1) << chunk_qubits) - 1);
+        switch (port) {
+        case 0: return port0[offset];
+        case 1: return port1[offset];
+        case 2: return port2[offset];
+        default: return port3[offset];
+        }
+    }
+};
+
+// Apply one gate in place to a state held in 2^chunk_bits buffers (1, 2 or 4; only the
+// first 2^chunk_bits chunk pointers are used), chunk j holding the amplitudes whose top
+// chunk_bits index bits equal j. Indices are 64-bit and the code is the same for every
+// chunk count.
+// The state is processed in groups: runs of 2^run_log2 consecutive amplitudes, where gate
+// qubits at or above run_log2 pair whole runs, so a group of 1, 2 or 4 runs holds every
+// amplitude the gate mixes (the runs may sit in different chunks). Each group is read into
+// an on-chip tile, updated with apply_tile_gate and written back to where it came from.
+// Diagonal gates stream the state in place.
+static void apply_gate_in_place(
+    amp_t *chunk0, amp_t *chunk1, amp_t *chunk2, amp_t *chunk3,  // State chunks (updated in place)
+    const amp_t *gate_matrix,          // Gate matrix or diagonal
+    int type,                          // Gate kind (gate_type, not GATE_BLOCK or GATE_PERMUTE)
+    int control,                       // Control qubit index (-1 for no control)
+    int target,                        // Target qubit index
+    int num_qubits,                    // Number of qubits
+    int chunk_bits                     // log2 of the number of chunks (0, 1 or 2)
+) {
+    const int chunk_qubits = num_qubits - chunk_bits;
+    const index_t num_states = index_t(1) << num_qubits;
+
+    amp_t matrix[GATE_MATRIX_SIZE];
+#pragma HLS ARRAY_PARTITION variable=matrix complete
+    const int entries = gate_matrix_entries(type, control);
+    for (int e = 0; e < GATE_MATRIX_SIZE; ++e) {
+        #pragma HLS PIPELINE II=1
+        matrix[e] = (e < entries) ? gate_matrix[e] : make_amp(0.0f, 0.0f);
+    }
+
+    if (type == GATE_DIAGONAL) {
+        in_place_diagonal_loop: for (index_t i = 0; i < num_states; ++i) {
+            #pragma HLS PIPELINE II=1
+            int bit = (i >> target) & 1;
+            int select = (control == -1) ? bit : ((bit << 1) | ((i >> control) & 1));
+            amp_t value = read_chunked(chunk0, chunk1, chunk2, chunk3, i, chunk_qubits);
+            write_chunked(chunk0, chunk1, chunk2, chunk3, i, chunk_qubits, matrix[select] * value);
+        }
+        return;
+    }
+
+    // Up to four runs must fit the tile
+    int run_log2 = (num_qubits < GATE_TILE_MAX_QUBITS - 2) ? num_qubits : GATE_TILE_MAX_QUBITS - 2;
+
+    // Run-select qubits of the gate in ascending order (high0 < high1, -1 if absent)
+    int qubit_a = (type == GATE_SINGLE) ? -1 : control;
+    int low = (qubit_a != -1 && qubit_a < target) ? qubit_a : target;
+    int high = (qubit_a != -1 && qubit_a < target) ? target : qubit_a;
+    int high0 = (low >= run_log2) ? low : ((high >= run_log2) ? high : -1);
+    int high1 = (low >= run_log2) ? high : -1;
+    int group_log2 = (high0 != -1) + (high1 != -1);
+
+    // Gate qubits renumbered for the tile: run offset bits, then the group member bits
+    int tile_target = (target < run_log2) ? target : ((target == high0) ? run_log2 : run_log2 + 1);
+    int tile_control = (qubit_a < run_log2) ? qubit_a : ((qubit_a == high0) ? run_log2 : run_log2 + 1);
+    int tile_qubits = run_log2 + group_log2;
+
+    const int run_size = 1 << run_log2;
+    const int tile_size = 1 << tile_qubits;
+    const index_t num_groups = index_t(1) << (num_qubits - tile_qubits);
+    const index_t stride0 = (high0 != -1) ? index_t(1) << high0 : 0;
+    const index_t stride1 = (high1 != -1) ? index_t(1) << high1 : 0;
+
+    amp_t tile[1 << GATE_TILE_MAX_QUBITS];
+#pragma HLS BIND_STORAGE variable=tile type=ram_2p impl=bram
+
+    group_loop: for (index_t c = 0; c < num_groups; ++c) {
+        index_t base = c << run_log2;
+        if (high0 != -1) {
+            base = insert_zero_bit64(base, high0);
+        }
+        if (high1 != -1) {
+            base = insert_zero_bit64(base, high1);
+        }
+
+        group_read_loop: for (int i = 0; i < tile_size; ++i) {
+            #pragma HLS PIPELINE II=1
+            int g = i >> run_log2;
+            index_t index = base + ((g & 1) ? stride0 : 0) + ((g >> 1) ? stride1 : 0) + (i & (run_size - 1));
+            tile[i] = read_chunked(chunk0, chunk1, chunk2, chunk3, index, chunk_qubits);
+        }
+
+        apply_tile_gate(tile, matrix, type, tile_control, tile_target, tile_qubits);
+
+        group_write_loop: for (int i = 0; i < tile_size; ++i) {
+            #pragma HLS PIPELINE II=1
+            int g = i >> run_log2;
+            index_t index = base + ((g & 1) ? stride0 : 0) + ((g >> 1) ? stride1 : 0) + (i & (run_size - 1));
+            write_chunked(chunk0, chunk1, chunk2, chunk3, index, chunk_qubits, tile[i]);
+        }
+    }
+}
+
+// Apply a gate whose qubits all lie inside a bank to the four bank quarters concurrently.
+// Each quarter is an independent (num_qubits - 2)-qubit state on its own AXI bundle.
+static void apply_gate_local_banks(
+    amp_t *in0, amp_t *in1, amp_t *in2, amp_t *in3,         // Input quarters (DDR[0..3])
+    amp_t *out0, amp_t *out1, amp_t *out2, amp_t *out3,     // Output quarters (DDR[0..3])
+    const amp_t matrix[4][GATE_MATRIX_SIZE],                // One matrix copy per bank
+    int type, int control, int target, int local_qubits
+) {
+#pragma HLS DATAFLOW
+    apply_gate(in0, matrix[0], out0, type, control, target, local_qubits);
+    apply_gate(in1, matrix[1], out1, type, control, target, local_qubits);
+    apply_gate(in2, matrix[2], out2, type, control, target, local_qubits);
+    apply_gate(in3, matrix[3], out3, type, control, target, local_qubits);
+}
+
+// Apply a gate that acts on one or both bank-select qubits (the top two). The amplitudes a
+// gate mixes then sit in different banks at the same local offset, or at that offset with
+// the gate's low qubit flipped. Each iteration reads those from all four banks, expands the
+// gate to a full matrix and writes one output per bank.
+static void apply_gate_cross_banks(
+    const amp_t *in0, const amp_t *in1, const amp_t *in2, const amp_t *in3,
+    amp_t *out0, amp_t *out1, amp_t *out2, amp_t *out3,
+    const amp_t *gate_matrix, int type, int control, int target, int num_qubits
+) {
+    const int local_qubits = num_qubits - 2;
+    const int local_size = 1 << local_qubits;
+    const int local_mask = local_size - 1;
+    const int width = (control == -1) ? 2 : 4;  // Single-qubit gates use the top-left 2x2
+
+    // Full matrix in the local index of gate_desc.h (bit 0 control, bit 1 target, or bit 0
+    // target for single-qubit gates)
+    amp_t full[GATE_MATRIX_SIZE];
+#pragma HLS ARRAY_PARTITION variable=full complete
+    for (int row = 0; row < 4; ++row) {
+        for (int col = 0; col < 4; ++col) {
+            amp_t value = make_amp(0.0f, 0.0f);
+            if (type == GATE_SINGLE) {
+                value = (row < 2 && col < 2) ? gate_matrix[row * 2 + col] : make_amp(0.0f, 0.0f);
+            }
+            else if (type == GATE_DIAGONAL) {
+                value = (row == col && row < width) ? gate_matrix[row] : make_amp(0.0f, 0.0f);
+            }
+            else if (type == GATE_TWO_QUBIT) {
+                value = gate_matrix[row * 4 + col];
+            }
+            else if ((row & 1) == 0 || (col & 1) == 0) {
+                // Controlled kinds act as the identity where the control bit is 0
+                value = (row == col) ? make_amp(1.0f, 0.0f) : make_amp(0.0f, 0.0f);
+            }
+            else {
+                amp_t x = ((row >> 1) != (col >> 1)) ? make_amp(1.0f, 0.0f) : make_amp(0.0f, 0.0f);
+                value = (type == GATE_CX) ? x : gate_matrix[(row >> 1) * 2 + (col >> 1)];
+            }
+            full[row * 4 + col] = value;
+        }
+    }
+
+    // Flipping the gate's low qubit (if any) gives the second local offset to read
+    int low_flip = 0;
+    if (target < local_qubits) {
+        low_flip |= 1 << target;
+    }
+    if (control >= 0 && control < local_qubits) {
+        low_flip |= 1 << control;
+    }
+    if (type == GATE_DIAGONAL) {
+        low_flip = 0; // Only the amplitude itself is needed, which keeps in-place updates safe
+    }
+
+    cross_bank_loop: for (int j = 0; j < local_size; ++j) {
+        #pragma HLS PIPELINE II=2
+        amp_t here[4], flipped[4];
+        here[0] = in0[j]; here[1] = in1[j]; here[2] = in2[j]; here[3] = in3[j];
+        int jf = j ^ low_flip;
+        flipped[0] = in0[jf]; flipped[1] = in1[jf]; flipped[2] = in2[jf]; flipped[3] = in3[jf];
+
+        amp_t result[4];
+        for (int b = 0; b < 4; ++b) {
+            int i = (b << local_qubits) | j;
+            int bt = (i >> target) & 1;
+            int bc = (control == -1) ? 0 : (i >> control) & 1;
+            int row = (control == -1) ? bt : (bc | (bt << 1));
+
+            amp_t sum = make_amp(0.0f, 0.0f);
+            for (int col = 0; col < 4; ++col) {
+                if (col >= width) {
+                    continue;
+                }
+                int ct = (control == -1) ? col : (col >> 1);
+                int cc = (control == -1) ? 0 : (col & 1);
+                int x = (i & ~(1 << target)) | (ct << target);
+                if (control >= 0) {
+                    x = (x & ~(1 << control)) | (cc << control);
+                }
+                amp_t value = ((x & local_mask) == j) ? here[x >> local_qubits] : flipped[x >> local_qubits];
+                sum += full[row * 4 + col] * value;
+            }
+            result[b] = sum;
+        }
+        out0[j] = result[0]; out1[j] = result[1]; out2[j] = result[2]; out3[j] = result[3];
+    }
+}
+
+// 512-bit word of the vadd_wide kernel: WIDE_LANES consecutive amplitudes, lane j in bits
+// [j * WIDE_LANE_BITS, (j + 1) * WIDE_LANE_BITS - 1] with the real part in the low half,
+// i.e. the byte layout of an amp_t array, so the host uses the same buffers as for vadd
+typedef ap_uint<512> wide_t;
+#define WIDE_LANE_BITS (2 * AMP_SCALAR_BITS)
+#if AMP_SCALAR_BITS == 16
+#define WIDE_LANES 16
+#define WIDE_LANES_LOG2 4
+#else
+#define WIDE_LANES 8
+#define WIDE_LANES_LOG2 3
+#endif
+
+// Words per burst in the vadd_wide chunk loops
+#define WIDE_BURST 64
+
+// Split a word into its amplitudes
+static void unpack_word(const wide_t &word, amp_t lanes[WIDE_LANES]) {
+#pragma HLS INLINE
+    for (int j = 0; j < WIDE_LANES; ++j) {
+        #pragma HLS UNROLL
+        unsigned int re = word.range(WIDE_LANE_BITS * j + AMP_SCALAR_BITS - 1, WIDE_LANE_BITS * j);
+        unsigned int im = word.range(WIDE_LANE_BITS * (j + 1) - 1, WIDE_LANE_BITS * j + AMP_SCALAR_BITS);
+        lanes[j] = amp_t(amp_scalar_from_bits(re), amp_scalar_from_bits(im));
+    }
+}
+
+// Pack amplitudes into a word
+static wide_t pack_word(const amp_t lanes[WIDE_LANES]) {
+#pragma HLS INLINE
+    wide_t word;
+    for (int j = 0; j < WIDE_LANES; ++j) {
+        #pragma HLS UNROLL
+        word.range(WIDE_LANE_BITS * j + AMP_SCALAR_BITS - 1, WIDE_LANE_BITS * j) = amp_scalar_to_bits(lanes[j].real());
+        word.range(WIDE_LANE_BITS * (j + 1) - 1, WIDE_LANE_BITS * j + AMP_SCALAR_BITS) = amp_scalar_to_bits(lanes[j].imag());
+    }
+    return word;
+}
+
+// Diagonal gate on whole words: each lane picks its phase from its own index bits. Words are
+// read and written once in order, so input and output may be the same buffer.
+static void apply_diagonal_wide(
+    const wide_t *state_vector,        // Input state, WIDE_LANES amplitudes per word
+    const amp_t *diagonal,             // Diagonal entries (2 for single-qubit, 4 for two-qubit)
+    wide_t *output_state_vector,       // Output state (may alias state_vector)
+    int control,                       // Control qubit index (-1 for single-qubit gates)
+    int target,                        // Target qubit index
+    int num_qubits                     // Number of qubits (at least WIDE_LANES_LOG2)
+) {
+    amp_t d[4];
+#pragma HLS ARRAY_PARTITION variable=d complete
+    diagonal_wide_load_loop: for (int e = 0; e < 4; ++e) {
+        #pragma HLS PIPELINE II=1
+        d[e] = (e < gate_matrix_entries(GATE_DIAGONAL, control)) ? diagonal[e] : make_amp(0.0f, 0.0f);
+    }
+
+    int num_words = 1 << (num_qubits - WIDE_LANES_LOG2);
+    diagonal_wide_loop: for (int w = 0; w < num_words; ++w) {
+        #pragma HLS PIPELINE II=1
+        amp_t lanes[WIDE_LANES];
+        unpack_word(state_vector[w], lanes);
+        for (int j = 0; j < WIDE_LANES; ++j) {
+            #pragma HLS UNROLL
+            int i = (w << WIDE_LANES_LOG2) | j;
+            int bit = (i >> target) & 1;
+            int select = (control == -1) ? bit : ((bit << 1) | ((i >> control) & 1));
+            lanes[j] = d[select] * lanes[j];
+        }
+        output_state_vector[w] = pack_word(lanes);
+    }
+}
+
+// Output amplitude o of a gate applied to a group of up to four words viewed as one small
+// state of 4 * WIDE_LANES amplitudes: the low WIDE_LANES_LOG2 index bits are the lane, the
+// next two select the word. control and target are positions in that small state.
+static amp_t group_gate_output(
+    const amp_t group[4 * WIDE_LANES], const amp_t m[GATE_MATRIX_SIZE],
+    int type, int control, int target, int o
+) {
+#pragma HLS INLINE
+    int bit = (o >> target) & 1;
+    int partner = o ^ (1 << target);
+    if (type == GATE_TWO_QUBIT) {
+        // Local index bit 0 is the control qubit, bit 1 the target qubit
+        int row = ((o >> control) & 1) | (bit << 1);
+        int base = o & ~((1 << control) | (1 << target));
+        return m[row * 4 + 0] * group[base] +
+               m[row * 4 + 1] * group[base | (1 << control)] +
+               m[row * 4 + 2] * group[base | (1 << target)] +
+               m[row * 4 + 3] * group[base | (1 << control) | (1 << target)];
+    }
+    if (type != GATE_SINGLE && ((o >> control) & 1) == 0) {
+        return group[o];  // Control not set
+    }
+    if (bit == 0) {
+        return m[0] * group[o] + m[1] * group[partner];
+    }
+    return m[2] * group[partner] + m[3] * group[o];
+}
+
+// Apply one gate to a state packed in 512-bit words. Gate qubits below WIDE_LANES_LOG2 pair
+// lanes inside a word; each qubit at or above it pairs whole words, so a group of 1, 2 or 4
+// words holds every amplitude the gate mixes. The state is walked in chunks of up to
+// WIDE_BURST consecutive words per group member: the chunks are burst-read into on-chip
+// buffers, then every output word is computed from the buffered group and written in one
+// beat, all lanes in parallel.
+static void apply_gate_wide(
+    const wide_t *state_vector,        // Input state, WIDE_LANES amplitudes per word
+    const amp_t *gate_matrix,          // Gate matrix (2x2 for single-qubit, 4x4 for two-qubit)
+    wide_t *output_state_vector,       // Output state
+    int type,                          // Gate kind (gate_type, not GATE_BLOCK or GATE_PERMUTE)
+    int control,                       // Control qubit index (-1 for no control)
+    int target,                        // Target qubit index
+    int num_qubits                     // Number of qubits (at least WIDE_LANES_LOG2)
+) {
+    if (type == GATE_DIAGONAL) {
+        apply_diagonal_wide(state_vector, gate_matrix, output_state_vector, control, target, num_qubits);
+        return;
+    }
+
+    // GATE_CX runs as a controlled X
+    amp_t m[GATE_MATRIX_SIZE];
+#pragma HLS ARRAY_PARTITION variable=m complete
+    const int entries = gate_matrix_entries(type, control);
+    for (int e = 0; e < GATE_MATRIX_SIZE; ++e) {
+        #pragma HLS PIPELINE II=1
+        amp_t x = make_amp((e == 1 || e == 2) ? 1.0f : 0.0f, 0.0f);
+        m[e] = (type == GATE_CX) ? x : ((e < entries) ? gate_matrix[e] : make_amp(0.0f, 0.0f));
+    }
+
+    // Word-select qubits of the gate in ascending order (high0 < high1, -1 if absent)
+    int qubit_a = (type == GATE_SINGLE || control == -1) ? -1 : control;
+    int low = (qubit_a != -1 && qubit_a < target) ? qubit_a : target;
+    int high = (qubit_a != -1 && qubit_a < target) ? target : qubit_a;
+    int high0 = (low >= WIDE_LANES_LOG2) ? low : ((high >= WIDE_LANES_LOG2) ? high : -1);
+    int high1 = (low >= WIDE_LANES_LOG2) ? high : -1;
+    int group_log2 = (high0 != -1) + (high1 != -1);
+
+    // Positions of the gate qubits inside the group
+    int group_target = (target < WIDE_LANES_LOG2) ? target : ((target == high0) ? WIDE_LANES_LOG2 : WIDE_LANES_LOG2 + 1);
+    int group_control = (qubit_a < WIDE_LANES_LOG2) ? qubit_a : ((qubit_a == high0) ? WIDE_LANES_LOG2 : WIDE_LANES_LOG2 + 1);
+
+    // Chunks must not straddle the lowest word-select bit
+    int num_words = 1 << (num_qubits - WIDE_LANES_LOG2);
+    int chunk_log2 = 6;  // log2(WIDE_BURST)
+    if (high0 != -1 && high0 - WIDE_LANES_LOG2 < chunk_log2) {
+        chunk_log2 = high0 - WIDE_LANES_LOG2;
+    }
+    if (num_qubits - WIDE_LANES_LOG2 < chunk_log2) {
+        chunk_log2 = num_qubits - WIDE_LANES_LOG2;
+    }
+    int chunk = 1 << chunk_log2;
+    int stride0 = (high0 != -1) ? 1 << (high0 - WIDE_LANES_LOG2) : 0;
+    int stride1 = (high1 != -1) ? 1 << (high1 - WIDE_LANES_LOG2) : 0;
+    int num_chunks = num_words >> (group_log2 + chunk_log2);
+    int chunk_words = chunk << group_log2;
+
+    wide_t buffer[4][WIDE_BURST];
+#pragma HLS ARRAY_PARTITION variable=buffer dim=1 complete
+
+    wide_chunk_loop: for (int c = 0; c < num_chunks; ++c) {
+        int base = c << chunk_log2;
+        if (high0 != -1) {
+            base = insert_zero_bit(base, high0 - WIDE_LANES_LOG2);
+        }
+        if (high1 != -1) {
+            base = insert_zero_bit(base, high1 - WIDE_LANES_LOG2);
+        }
+
+        wide_read_loop: for (int k = 0; k < chunk_words; ++k) {
+            #pragma HLS PIPELINE II=1
+            int g = k >> chunk_log2;
+            int i = k & (chunk - 1);
+            buffer[g][i] = state_vector[base + ((g & 1) ? stride0 : 0) + ((g >> 1) ? stride1 : 0) + i];
+        }
+
+        wide_compute_loop: for (int k = 0; k < chunk_words; ++k) {
+            #pragma HLS PIPELINE II=1
+            int g = k >> chunk_log2;
+            int i = k & (chunk - 1);
+
+            amp_t group[4 * WIDE_LANES];
+#pragma HLS ARRAY_PARTITION variable=group complete
+            for (int b = 0; b < 4; ++b) {
+                #pragma HLS UNROLL
+                if (b < (1 << group_log2)) {
+                    unpack_word(buffer[b][i], group + b * WIDE_LANES);
+                }
+            }
+
+            amp_t lanes[WIDE_LANES];
+            for (int j = 0; j < WIDE_LANES; ++j) {
+                #pragma HLS UNROLL
+                lanes[j] = group_gate_output(group, m, type, group_control, group_target, g * WIDE_LANES + j);
+            }
+            output_state_vector[base + ((g & 1) ? stride0 : 0) + ((g >> 1) ? stride1 : 0) + i] = pack_word(lanes);
+        }
+    }
+}
+
+extern "C" {
+    // Apply a single gate per launch. For GATE_DIAGONAL the host may pass the same buffer
+    // as state_vector and output_state_vector to update the state in place. With
+    // AMP_LAYOUT_SOA the state buffers hold the real plane followed by the imaginary plane.
+    void vadd(
+#ifdef AMP_LAYOUT_SOA
+        amp_scalar_t *state_vector,    // Input state vector, 2^num_qubits real parts then imaginary parts
+        amp_t *gate_matrix,            // Input gate matrix (2x2 for single-qubit, 4x4 for two-qubit)
+        amp_scalar_t *output_state_vector,  // Output state vector, same layout
+#else
+        amp_t *state_vector,           // Input complex state vector
+        amp_t *gate_matrix,            // Input gate matrix (2x2 for single-qubit, 4x4 for two-qubit)
+        amp_t *output_state_vector,    // Output complex state vector
+#endif
+        int type,                      // Gate kind (gate_type)
+        int control,                   // Control qubit index (-1 for no control)
+        int target,                    // Target qubit index
+        int num_qubits                 // Number of qubits
+    ) {
+#pragma HLS INTERFACE m_axi port=state_vector depth=1024 bundle=gmem0
+#pragma HLS INTERFACE m_axi port=gate_matrix depth=32 bundle=gmem1
+#pragma HLS INTERFACE m_axi port=output_state_vector depth=1024 bundle=gmem2
+#pragma HLS INTERFACE s_axilite port=type
+#pragma HLS INTERFACE s_axilite port=control
+#pragma HLS INTERFACE s_axilite port=target
+#pragma HLS INTERFACE s_axilite port=num_qubits
+#pragma HLS INTERFACE s_axilite port=return
+
+#ifdef AMP_LAYOUT_SOA
+        int num_states = 1 << num_qubits;
+        soa_const_state in = {state_vector, state_vector + num_states};
+        soa_state out = {output_state_vector, output_state_vector + num_states};
+        apply_gate(in, gate_matrix, out, type, control, target, num_qubits);
+#else
+        apply_gate(state_vector, gate_matrix, output_state_vector, type, control, target, num_qubits);
+#endif
+    }
+
+    // Apply a whole circuit per launch. The gate list stays on the device and the two
+    // state buffers swap input/output roles after every gate, except for diagonal gates and
+    // tile blocks, which update the current buffer in place.
+    void vadd_circuit(
+        amp_t *state_a,                // State buffer holding the initial state
+        amp_t *state_b,                // Second state buffer
+        const gate_desc *gates,        // Packed gate descriptors
+        const amp_t *gate_matrices,    // Matrix pool, GATE_MATRIX_SIZE entries per descriptor
+        int num_gates,                 // Number of gates in the circuit
+        int num_qubits                 // Number of qubits
+    ) {
+#pragma HLS INTERFACE m_axi port=state_a depth=1024 bundle=gmem0
+#pragma HLS INTERFACE m_axi port=state_b depth=1024 bundle=gmem1
+#pragma HLS INTERFACE m_axi port=gates depth=64 bundle=gmem2
+#pragma HLS INTERFACE m_axi port=gate_matrices depth=1024 bundle=gmem2
+#pragma HLS INTERFACE s_axilite port=num_gates
+#pragma HLS INTERFACE s_axilite port=num_qubits
+#pragma HLS INTERFACE s_axilite port=return
+
+        bool in_a = true; // Which buffer currently holds the state
+
+        int g = 0;
+        circuit_loop: while (g < num_gates) {
+            gate_desc gate = gates[g];
+            const amp_t *gate_matrix = gate_matrices + gate.matrix * GATE_MATRIX_SIZE;
+
+            if (gate.type == GATE_BLOCK) {
+                // The block's gates follow the header and are consumed with it
+                if (in_a) {
+                    apply_block(state_a, gates + g + 1, gate_matrices, gate.control, gate.target, num_qubits);
+                }
+                else {
+                    apply_block(state_b, gates + g + 1, gate_matrices, gate.control, gate.target, num_qubits);
+                }
+                g += gate.control;
+            }
+            else if (gate.type == GATE_DIAGONAL) {
+                if (in_a) {
+                    apply_diagonal(state_a, gate_matrix, state_a, gate.control, gate.target, num_qubits);
+                }
+                else {
+                    apply_diagonal(state_b, gate_matrix, state_b, gate.control, gate.target, num_qubits);
+                }
+            }
+            else {
+                if (in_a) {
+                    apply_gate(state_a, gate_matrix, state_b, gate.type, gate.control, gate.target, num_qubits);
+                }
+                else {
+                    apply_gate(state_b, gate_matrix, state_a, gate.type, gate.control, gate.target, num_qubits);
+                }
+                in_a = !in_a;
+            }
+            ++g;
+        }
+    }
+
+    // Apply one gate per launch to a state striped over the four DDR banks: quarter k holds
+    // the amplitudes whose top two index bits equal k and sits in DDR[k] behind its own
+    // bundle, so gates on the lower qubits stream all four banks at once. For GATE_DIAGONAL
+    // the host may pass the same buffers as input and output (in-place update).
+    void vadd_banked(
+        amp_t *in0, amp_t *in1, amp_t *in2, amp_t *in3,         // Input quarters
+        amp_t *out0, amp_t *out1, amp_t *out2, amp_t *out3,     // Output quarters
+        amp_t *gate_matrix,            // Gate matrix (2x2 for single-qubit, 4x4 for two-qubit)
+        int type,                      // Gate kind (gate_type)
+        int control,                   // Control qubit index (-1 for no control)
+        int target,                    // Target qubit index
+        int num_qubits                 // Number of qubits (at least 3)
+    ) {
+#pragma HLS INTERFACE m_axi port=in0 depth=256 bundle=gmem0
+#pragma HLS INTERFACE m_axi port=out0 depth=256 bundle=gmem0
+#pragma HLS INTERFACE m_axi port=in1 depth=256 bundle=gmem1
+#pragma HLS INTERFACE m_axi port=out1 depth=256 bundle=gmem1
+#pragma HLS INTERFACE m_axi port=in2 depth=256 bundle=gmem2
+#pragma HLS INTERFACE m_axi port=out2 depth=256 bundle=gmem2
+#pragma HLS INTERFACE m_axi port=in3 depth=256 bundle=gmem3
+#pragma HLS INTERFACE m_axi port=out3 depth=256 bundle=gmem3
+#pragma HLS INTERFACE m_axi port=gate_matrix depth=32 bundle=gmem4
+#pragma HLS INTERFACE s_axilite port=type
+#pragma HLS INTERFACE s_axilite port=control
+#pragma HLS INTERFACE s_axilite port=target
+#pragma HLS INTERFACE s_axilite port=num_qubits
+#pragma HLS INTERFACE s_axilite port=return
+
+        const int local_qubits = num_qubits - 2;
+        bool local = target < local_qubits && control < local_qubits;
+
+        if (local) {
+            amp_t matrix[4][GATE_MATRIX_SIZE];
+#pragma HLS ARRAY_PARTITION variable=matrix dim=1 complete
+            for (int e = 0; e < GATE_MATRIX_SIZE; ++e) {
+                #pragma HLS PIPELINE II=1
+                amp_t value = gate_matrix[e];
+                for (int b = 0; b < 4; ++b) {
+                    matrix[b][e] = value;
+                }
+            }
+            apply_gate_local_banks(in0, in1, in2, in3, out0, out1, out2, out3, matrix, type, control, target, local_qubits);
+        }
+        else {
+            apply_gate_cross_banks(in0, in1, in2, in3, out0, out1, out2, out3, gate_matrix, type, control, target, num_qubits);
+        }
+    }
+
+    // Apply one gate per launch to a state read and written as 512-bit words (WIDE_LANES
+    // amplitudes per AXI beat), same arguments as vadd. Needs at least WIDE_LANES_LOG2 qubits;
+    // GATE_PERMUTE is not supported. For GATE_DIAGONAL the host may pass the same buffer as
+    // input and output (in-place update).
+    void vadd_wide(
+        const wide_t *state_vector,    // Input state vector
+        amp_t *gate_matrix,            // Gate matrix (2x2 for single-qubit, 4x4 for two-qubit)
+        wide_t *output_state_vector,   // Output state vector
+        int type,                      // Gate kind (gate_type)
+        int control,                   // Control qubit index (-1 for no control)
+        int target,                    // Target qubit index
+        int num_qubits                 // Number of qubits
+    ) {
+#pragma HLS INTERFACE m_axi port=state_vector depth=128 bundle=gmem0 max_read_burst_length=64
+#pragma HLS INTERFACE m_axi port=gate_matrix depth=32 bundle=gmem1
+#pragma HLS INTERFACE m_axi port=output_state_vector depth=128 bundle=gmem2 max_write_burst_length=64
+#pragma HLS INTERFACE s_axilite port=type
+#pragma HLS INTERFACE s_axilite port=control
+#pragma HLS INTERFACE s_axilite port=target
+#pragma HLS INTERFACE s_axilite port=num_qubits
+#pragma HLS INTERFACE s_axilite port=return
+
+        apply_gate_wide(state_vector, gate_matrix, output_state_vector, type, control, target, num_qubits);
+    }
+
+    // Apply one gate per launch in place, with no second state buffer, so a state can use
+    // whole banks: 30 qubits of complex<float> (8 GB) fit one chunk in DDR[0], and with four
+    // chunks, one per bank, the state can grow to 32 qubits (32 GB). The host passes
+    // 2^chunk_bits chunk buffers and small placeholders for the unused chunk ports.
+    // GATE_PERMUTE is not supported.
+    void vadd_inplace(
+        amp_t *chunk0,                 // State chunk 0 (DDR[0]), updated in place
+        amp_t *chunk1,                 // State chunk 1 (DDR[1])
+        amp_t *chunk2,                 // State chunk 2 (DDR[2])
+        amp_t *chunk3,                 // State chunk 3 (DDR[3])
+        amp_t *gate_matrix,            // Gate matrix (2x2 for single-qubit, 4x4 for two-qubit)
+        int type,                      // Gate kind (gate_type)
+        int control,                   // Control qubit index (-1 for no control)
+        int target,                    // Target qubit index
+        int num_qubits,                // Number of qubits
+        int chunk_bits                 // log2 of the number of chunks (0, 1 or 2)
+    ) {
+#pragma HLS INTERFACE m_axi port=chunk0 depth=1024 bundle=gmem0
+#pragma HLS INTERFACE m_axi port=chunk1 depth=1024 bundle=gmem1
+#pragma HLS INTERFACE m_axi port=chunk2 depth=1024 bundle=gmem2
+#pragma HLS INTERFACE m_axi port=chunk3 depth=1024 bundle=gmem3
+#pragma HLS INTERFACE m_axi port=gate_matrix depth=32 bundle=gmem4
+#pragma HLS INTERFACE s_axilite port=type
+#pragma HLS INTERFACE s_axilite port=control
+#pragma HLS INTERFACE s_axilite port=target
+#pragma HLS INTERFACE s_axilite port=num_qubits
+#pragma HLS INTERFACE s_axilite port=chunk_bits
+#pragma HLS INTERFACE s_axilite port=return
+
+        apply_gate_in_place(chunk0, chunk1, chunk2, chunk3, gate_matrix, type, control, target, num_qubits, chunk_bits);
+    }
+
+    // Draw measurement shots from a state resident on the device (state_sampling.h), so only
+    // the distinct outcomes and their counts cross PCIe instead of the 2^n amplitudes. The
+    // state is 2^chunk_bits chunks (1, 2 or 4), chunk j on port (first_port + j) % 4: the
+    // vadd_inplace chunks and the vadd_banked quarters with first_port 0, or one state buffer
+    // of vadd (DDR[0]), vadd_wide (DDR[1]) or vadd_circuit (DDR[0] or DDR[2]) behind the
+    // port of its bank. Unused ports get placeholders, as for vadd_inplace.
+    void vadd_sample(
+        const amp_t *chunk0,           // Port 0 (DDR[0])
+        const amp_t *chunk1,           // Port 1 (DDR[1])
+        const amp_t *chunk2,           // Port 2 (DDR[2])
+        const amp_t *chunk3,           // Port 3 (DDR[3])
+        double *block_prefix,          // Scratch: prefix sums of |amp|^2 per 2^SAMPLE_BLOCK_LOG2 block
+        shot_count *results,           // Record 0: {outcomes, shots}, then one record per outcome
+        int num_qubits,                // Number of qubits
+        int chunk_bits,                // log2 of the number of chunks (0, 1 or 2)
+        int first_port,                // Port of chunk 0
+        long long num_shots,           // Shots to draw
+        unsigned long long seed        // Random seed
+    ) {
+#pragma HLS INTERFACE m_axi port=chunk0 depth=1024 bundle=gmem0
+#pragma HLS INTERFACE m_axi port=chunk1 depth=1024 bundle=gmem1
+#pragma HLS INTERFACE m_axi port=chunk2 depth=1024 bundle=gmem2
+#pragma HLS INTERFACE m_axi port=chunk3 depth=1024 bundle=gmem3
+#pragma HLS INTERFACE m_axi port=block_prefix depth=1024 bundle=gmem4
+#pragma HLS INTERFACE m_axi port=results depth=1024 bundle=gmem4
+#pragma HLS INTERFACE s_axilite port=num_qubits
+#pragma HLS INTERFACE s_axilite port=chunk_bits
+#pragma HLS INTERFACE s_axilite port=first_port
+#pragma HLS INTERFACE s_axilite port=num_shots
+#pragma HLS INTERFACE s_axilite port=seed
+#pragma HLS INTERFACE s_axilite port=return
+
+        port_chunks_view state = {chunk0, chunk1, chunk2, chunk3, num_qubits - chunk_bits, first_port};
+        double total = sample_block_prefix(state, num_qubits, block_prefix);
+        long long num_records = sample_shots(state, num_qubits, block_prefix, total, num_shots, seed, results + 1);
+        results[0].index = num_records;
+        results[0].count = num_shots;
+    }
+
+    // Evaluate Pauli-string expectation values on a state resident on the device
+    // (pauli_expectation.h); only one double per string is read back. The state is passed
+    // as for vadd_sample. The strings must be sorted by x_mask; each group of up to
+    // PAULI_GROUP_MAX_TERMS strings with the same x_mask costs one pass over the state.
+    void vadd_expect(
+        const amp_t *chunk0,           // Port 0 (DDR[0])
+        const amp_t *chunk1,           // Port 1 (DDR[1])
+        const amp_t *chunk2,           // Port 2 (DDR[2])
+        const amp_t *chunk3,           // Port 3 (DDR[3])
+        const pauli_term *terms,       // Pauli strings, sorted by x_mask
+        double *values,                // Expectation value of each string
+        int num_terms,                 // Number of strings
+        int num_qubits,                // Number of qubits
+        int chunk_bits,                // log2 of the number of chunks (0, 1 or 2)
+        int first_port                 // Port of chunk 0
+    ) {
+#pragma HLS INTERFACE m_axi port=chunk0 depth=1024 bundle=gmem0
+#pragma HLS INTERFACE m_axi port=chunk1 depth=1024 bundle=gmem1
+#pragma HLS INTERFACE m_axi port=chunk2 depth=1024 bundle=gmem2
+#pragma HLS INTERFACE m_axi port=chunk3 depth=1024 bundle=gmem3
+#pragma HLS INTERFACE m_axi port=terms depth=64 bundle=gmem4
+#pragma HLS INTERFACE m_axi port=values depth=64 bundle=gmem4
+#pragma HLS INTERFACE s_axilite port=num_terms
+#pragma HLS INTERFACE s_axilite port=num_qubits
+#pragma HLS INTERFACE s_axilite port=chunk_bits
+#pragma HLS INTERFACE s_axilite port=first_port
+#pragma HLS INTERFACE s_axilite port=return
+
+        port_chunks_view state = {chunk0, chunk1, chunk2, chunk3, num_qubits - chunk_bits, first_port};
+        int first = 0;
+        group_loop: while (first < num_terms) {
+            pauli_term group[PAULI_GROUP_MAX_TERMS];
+            double group_values[PAULI_GROUP_MAX_TERMS];
+            int size = pauli_group_size(terms, first, num_terms);
+            for (int t = 0; t < size; ++t) {
+                group[t] = terms[first + t];
+            }
+            pauli_group_expectation(state, num_qubits, group, size, group_values);
+            for (int t = 0; t < size; ++t) {
+                values[first + t] = group_values[t];
+            }
+            first += size;
+        }
+    }
+}
@@ -0,0 +1,292 @@
+#!/usr/bin/env python3
+"""Benchmark driver: runs synthetic and QASMBench circuits against several built host apps
+(version_1.0 ... version_1.3, half_codes, the version_1.3 CPU backend) and writes the
+results as CSV and JSON.
+
+Every app is run the way the sw_emu/hw scripts run it: from a work directory "run" whose
+parent holds quantum_circuit_gates.csv, with vadd.xclbin linked next to it. An app is
+given as
+
+    --app NAME=COMMAND
+
+where COMMAND is the command line to run (split like a shell would). If COMMAND contains
+{gates}, it is replaced by the circuit file and QASM and generated circuits are passed
+straight to the app (version_1.3 reads them with --gates); otherwise only CSV circuits are
+run on it.
+--amp-bytes NAME=N sets the bytes per amplitude of an app (default: from the
+"Amplitudes: complex <type>" line version_1.3 prints, else 8; half_codes stores 4).
+
+Metrics, per run:
+  apply_ms          time the host reports for applying the gates ("Applied N gates ... in X ms")
+  end_to_end_ms     wall time of the whole process (device open, xclbin load, I/O included)
+  gates_per_s       applied gate records per second of apply_ms
+  amp_updates_per_s 2^n amplitude updates per gate record
+  effective_gbps    bytes a gate moves in theory, one read and one write of the whole state
+                    (2 * 2^n * amp_bytes), times the gate records, over apply_ms. Tile blocks
+                    and fused gates move less than this, so their figure can exceed the peak.
+If COMMAND contains {bench}, it is replaced by a file name for the per-gate kernel times the
+host writes with "--bench {bench}", and those are summarised as well (kernel_us_mean/median/
+max and kernel_gbps over the summed kernel time). version_1.3 rejects --bench with --circuit,
+--stream and --cus, where a launch covers many gates.
+
+Example (hardware builds of 1.2 and 1.3 in ~/q2sv, QASMBench file, 10 to 26 qubits):
+    python3 Scripts/bench.py --xclbin-dir ~/q2sv \\
+        --app "1.2=~/q2sv/1.2/app.exe --bench {bench}" --app "1.3=~/q2sv/1.3/app.exe --output none" \\
+        --app 1.3-circuit="~/q2sv/1.3/app.exe --circuit --output none --gates {gates}" \\
+        --qubits 10:26:4 --mix single,cx,mixed --qasm qf21_n15_transpiled.qasm \\
+        --csv bench.csv --json bench.json
+--xclbin-dir DIR links DIR/NAME/vadd.xclbin for app NAME (or --xclbin FILE for all of them).
+
+--generate SPEC adds circuits from the version_1.3 generator (circuit_generator.h: random,
+qft, ghz, qv or diagonal, e.g. "random,depth=20,targets=high"). A spec without qubits= is
+swept over --qubits. --generator COMMAND is the version_1.3 app.exe that compiles each spec
+to a .q2sv file once ("--generate SPEC --compile FILE"); the file is then run on every app
+with {gates}:
+    python3 Scripts/bench.py --generator ~/q2sv/1.3/app.exe --generate qv --generate diagonal,targets=high \
+        --mix "" --qubits 20:30:2 --app "1.3=~/q2sv/1.3/app.exe --gates {gates} --output none" \
+        --app "cpu=~/q2sv/1.3/app.exe --backend cpu --gates {gates} --output none"
+"""
+
+import argparse
+import cmath
+import csv
+import json
+import math
+import os
+import random
+import re
+import shlex
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+# Single-qubit gates of the synthetic mixes. The per-gate kernels of version_1.0 ... 1.2 and
+# half_codes apply every controlled gate as a CX, so the two-qubit gate of the mixes is CX.
+def h_matrix():
+    s = 1 / math.sqrt(2)
+    return [[s, s], [s, -s]]
+
+def rz_matrix(theta):
+    return [[cmath.exp(-0.5j * theta), 0], [0, cmath.exp(0.5j * theta)]]
+
+def u3_matrix(theta, phi, lam):
+    return [[math.cos(theta / 2), -cmath.exp(1j * lam) * math.sin(theta / 2)],
+            [cmath.exp(1j * phi) * math.sin(theta / 2), cmath.exp(1j * (phi + lam)) * math.cos(theta / 2)]]
+
+CX_MATRIX = [[1, 0, 0, 0], [0, 0, 0, 1], [0, 0, 1, 0], [0, 1, 0, 0]]
+
+# Fraction of CX gates per mix
+MIXES = {"single": 0.0, "cx": 1.0, "mixed": 0.5}
+
+
+def format_entry(value):
+    # Fixed notation: parse_matrix in host.cpp reads the sign of the imaginary part after
+    # the first character, so exponents like 1e-17 must not appear
+    value = complex(value)
+    return "({:.9f}{:+.9f}j)".format(value.real, value.imag)
+
+
+def write_synthetic_csv(path, num_qubits, num_gates, mix, seed):
+    """Write a random circuit in the Qasm2CSV.ipynb layout read by every host.cpp"""
+    rng = random.Random(seed)
+    with open(path, "w") as f:
+        f.write("Gate Number,Gate Name,Control Qubit,Target Qubit,Matrix,{}\n".format(num_qubits))
+        for i in range(num_gates):
+            if num_qubits > 1 and rng.random() < MIXES[mix]:
+                control, target = rng.sample(range(num_qubits), 2)
+                name, matrix = "cx", CX_MATRIX
+            else:
+                control, target = "", rng.randrange(num_qubits)
+                kind = rng.choice(["h", "rz", "u3"])
+                name = kind
+                if kind == "h":
+                    matrix = h_matrix()
+                elif kind == "rz":
+                    matrix = rz_matrix(rng.uniform(0, 2 * math.pi))
+                else:
+                    matrix = u3_matrix(*(rng.uniform(0, 2 * math.pi) for _ in range(3)))
+            text = "[" + ", ".join("[" + ", ".join(format_entry(x) for x in row) + "]" for row in matrix) + "]"
+            f.write('Gate {},{},{},{},"{}"\n'.format(i + 1, name, control, target, text))
+
+
+def parse_range(text):
+    """10,14,18 or 10:30:2 (inclusive)"""
+    values = []
+    for part in text.split(","):
+        if ":" in part:
+            fields = [int(x) for x in part.split(":")]
+            step = fields[2] if len(fields) > 2 else 1
+            values.extend(range(fields[0], fields[1] + 1, step))
+        elif part:
+            values.append(int(part))
+    return values
+
+
+def parse_pairs(items, what):
+    pairs = {}
+    for item in items or []:
+        if "=" not in item:
+            sys.exit("Invalid {} (expected NAME=VALUE): {}".format(what, item))
+        name, value = item.split("=", 1)
+        pairs[name] = value
+    return pairs
+
+
+AMP_BYTES = {"float": 8, "half": 4, "bfloat16": 4, "fixed": 8}
+
+
+def run_app(name, command, circuit, work_dir, xclbin, amp_bytes, timeout):
+    """Run one app on one circuit and return the result row"""
+    run_dir = os.path.join(work_dir, "run")
+    shutil.rmtree(run_dir, ignore_errors=True)
+    os.makedirs(run_dir)
+    if xclbin:
+        os.symlink(os.path.abspath(xclbin), os.path.join(run_dir, "vadd.xclbin"))
+    bench_file = os.path.join(run_dir, "bench_gates.csv")
+    argv = [os.path.expanduser(arg).replace("{gates}", os.path.abspath(circuit["path"])).replace("{bench}", bench_file)
+            for arg in shlex.split(command)]
+    if "{gates}" not in command:
+        shutil.copyfile(circuit["path"], os.path.join(work_dir, "quantum_circuit_gates.csv"))
+
+    row = {"app": name, "circuit": circuit["name"], "mix": circuit["mix"], "qubits": circuit["qubits"],
+           "gates": None, "amp_bytes": amp_bytes, "status": "ok", "apply_ms": None, "end_to_end_ms": None,
+           "gates_per_s": None, "amp_updates_per_s": None, "effective_gbps": None,
+           "kernel_us_mean": None, "kernel_us_median": None, "kernel_us_max": None, "kernel_gbps": None}
+    start = time.perf_counter()
+    try:
+        result = subprocess.run(argv, cwd=run_dir, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                universal_newlines=True, timeout=timeout)
+    except (OSError, subprocess.TimeoutExpired) as e:
+        row["status"] = "error: {}".format(e)
+        return row
+    row["end_to_end_ms"] = (time.perf_counter() - start) * 1e3
+    output = result.stdout
+    if result.returncode != 0:
+        row["status"] = "exit {}: {}".format(result.returncode, output.strip().splitlines()[-1] if output.strip() else "")
+        return row
+
+    qubits = re.search(r"on (\d+) qubits", output)
+    if qubits:
+        row["qubits"] = int(qubits.group(1))
+    precision = re.search(r"Amplitudes: complex (\w+)", output)
+    if row["amp_bytes"] is None:
+        row["amp_bytes"] = AMP_BYTES.get(precision.group(1), 8) if precision else 8
+    applied = re.search(r"Applied (\d+) gates on the \w+ in ([0-9.eE+-]+) ms", output)
+    if not applied or row["qubits"] is None:
+        row["status"] = "no timing in output"
+        return row
+
+    gates = int(applied.group(1))
+    apply_s = float(applied.group(2)) / 1e3
+    states = 2 ** row["qubits"]
+    gate_bytes = 2 * states * row["amp_bytes"]
+    row["gates"] = gates
+    row["apply_ms"] = apply_s * 1e3
+    if apply_s > 0:
+        row["gates_per_s"] = gates / apply_s
+        row["amp_updates_per_s"] = gates * states / apply_s
+        row["effective_gbps"] = gates * gate_bytes / apply_s / 1e9
+
+    if "{bench}" in command and os.path.exists(bench_file):
+        with open(bench_file) as f:
+            times = [float(r["kernel_us"]) for r in csv.DictReader(f)]
+        if times:
+            row["kernel_us_mean"] = statistics.mean(times)
+            row["kernel_us_median"] = statistics.median(times)
+            row["kernel_us_max"] = max(times)
+            total_s = sum(times) / 1e6
+            if total_s > 0:
+                row["kernel_gbps"] = len(times) * gate_bytes / total_s / 1e9
+    return row
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Sweep circuits, qubit counts and host apps; write CSV/JSON metrics")
+    parser.add_argument("--app", action="append", required=True, help="NAME=COMMAND (repeatable)")
+    parser.add_argument("--amp-bytes", action="append", help="NAME=BYTES per amplitude (repeatable)")
+    parser.add_argument("--xclbin", help="xclbin linked as vadd.xclbin for every app")
+    parser.add_argument("--xclbin-dir", help="directory holding NAME/vadd.xclbin per app")
+    parser.add_argument("--qubits", default="10:30:4", help="synthetic qubit counts, e.g. 10,14 or 10:30:2")
+    parser.add_argument("--gates", type=int, default=200, help="gates per synthetic circuit")
+    parser.add_argument("--mix", default="single,cx,mixed", help="synthetic gate mixes: " + ", ".join(MIXES))
+    parser.add_argument("--csv-circuit", action="append", default=[], help="Qasm2CSV circuit file (repeatable)")
+    parser.add_argument("--qasm", action="append", default=[], help="OpenQASM circuit, for apps with {gates}")
+    parser.add_argument("--generate", action="append", default=[], help="version_1.3 generator spec (repeatable)")
+    parser.add_argument("--generator", help="version_1.3 app.exe that compiles the --generate specs")
+    parser.add_argument("--repeat", type=int, default=1, help="runs per app and circuit")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--timeout", type=float, default=3600, help="seconds per run")
+    parser.add_argument("--csv", default="bench.csv", help="CSV output")
+    parser.add_argument("--json", default="bench.json", help="JSON output")
+    args = parser.parse_args()
+
+    if args.generate and not args.generator:
+        sys.exit("--generate needs --generator")
+    apps = parse_pairs(args.app, "--app")
+    amp_bytes = {name: int(value) for name, value in parse_pairs(args.amp_bytes, "--amp-bytes").items()}
+    mixes = [m for m in args.mix.split(",") if m]
+    for mix in mixes:
+        if mix not in MIXES:
+            sys.exit("Unknown mix: {} ({})".format(mix, ", ".join(MIXES)))
+
+    work_dir = tempfile.mkdtemp(prefix="q2sv_bench_")
+    circuits = []
+    for qubits in parse_range(args.qubits):
+        for mix in mixes:
+            path = os.path.join(work_dir, "synthetic_{}_{}.csv".format(mix, qubits))
+            write_synthetic_csv(path, qubits, args.gates, mix, args.seed + qubits)
+            circuits.append({"name": os.path.basename(path), "path": path, "mix": mix, "qubits": qubits, "direct": False})
+    for path in args.csv_circuit:
+        circuits.append({"name": os.path.basename(path), "path": path, "mix": "file", "qubits": None, "direct": False})
+    for path in args.qasm:
+        circuits.append({"name": os.path.basename(path), "path": path, "mix": "file", "qubits": None, "direct": True})
+    for spec in args.generate:
+        sweep = [None] if "qubits=" in spec else parse_range(args.qubits)
+        for qubits in sweep:
+            full_spec = spec if qubits is None else "{},qubits={}".format(spec, qubits)
+            if "seed=" not in full_spec:
+                full_spec += ",seed={}".format(args.seed)
+            path = os.path.join(work_dir, "generated_{}.q2sv".format(len(circuits)))
+            compile_argv = shlex.split(os.path.expanduser(args.generator)) + ["--generate", full_spec, "--compile", path]
+            result = subprocess.run(compile_argv, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+            if result.returncode != 0:
+                sys.exit("Generating {} failed: {}".format(full_spec, result.stdout.strip()))
+            circuits.append({"name": full_spec, "path": path, "mix": spec.split(",")[0], "qubits": qubits, "direct": True})
+
+    rows = []
+    for circuit in circuits:
+        for name, command in apps.items():
+            if circuit["direct"] and "{gates}" not in command:
+                continue  # This app only reads the CSV layout
+            xclbin = args.xclbin
+            if args.xclbin_dir:
+                xclbin = os.path.join(os.path.expanduser(args.xclbin_dir), name, "vadd.xclbin")
+            for rep in range(args.repeat):
+                row = run_app(name, command, circuit, work_dir, xclbin, amp_bytes.get(name), args.timeout)
+                row["repeat"] = rep
+                rows.append(row)
+                print("{:<14} {:<28} {:>3} qubits  {}  apply {} ms  {} GB/s".format(
+                    name, circuit["name"], "-" if row["qubits"] is None else row["qubits"], row["status"],
+                    "-" if row["apply_ms"] is None else "{:.3f}".format(row["apply_ms"]),
+                    "-" if row["effective_gbps"] is None else "{:.2f}".format(row["effective_gbps"])))
+                sys.stdout.flush()
+
+    fields = ["app", "circuit", "mix", "qubits", "gates", "repeat", "status", "amp_bytes", "apply_ms",
+              "end_to_end_ms", "gates_per_s", "amp_updates_per_s", "effective_gbps",
+              "kernel_us_mean", "kernel_us_median", "kernel_us_max", "kernel_gbps"]
+    with open(args.csv, "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=fields)
+        writer.writeheader()
+        for row in rows:
+            writer.writerow({k: ("" if row[k] is None else row[k]) for k in fields})
+    with open(args.json, "w") as f:
+        json.dump({"apps": apps, "gates_per_circuit": args.gates, "runs": rows}, f, indent=2)
+    shutil.rmtree(work_dir, ignore_errors=True)
+    print("Wrote {} runs to {} and {}".format(len(rows), args.csv, args.json))
+
+
+if __name__ == "__main__":
+    main()
@@ -12,6 +12,7 @@
 #include <stdexcept>
 #include <algorithm>
 #include <regex>
+#include <chrono>
 //#include <boost/multiprecision/cpp_bin_float.hpp>
 #include "half.hpp" // Adjust path as necessary
 
@@ -128,6 +129,23 @@ int main(int argc, char** argv) {
     std::string binaryFile = "./vadd.xclbin";
     int device_index = 0;
 
+    // Parse command line options
+    // --debug-readback: read the state back from the device after every gate (verification only)
+    // --bench <file>: write the kernel time of every gate to <file> as CSV (Scripts/bench.py)
+    bool debug_readback = false;
+    std::string bench_file;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--debug-readback") {
+            debug_readback = true;
+        } else if (arg == "--bench" && i + 1 < argc) {
+            bench_file = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
     // Load device and xclbin
     std::cout << "Opening the device " << device_index << std::endl;
     auto device = xrt::device(device_index);
@@ -197,7 +215,17 @@ std::cout << std::endl;*/
     state_real_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
     state_imag_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
     
-    std::cout << real_parts_list.size() << "\n";
+    std::cout << "Read " << real_parts_list.size() << " gates on " << num_qubits << " qubits\n";
+
+    // Ping-pong buffer pairs: the kernel reads state_bos[src] and writes state_bos[1 - src].
+    // The roles swap after every gate so the state stays resident on the device and
+    // only crosses PCIe once at load and once at readback.
+    xrt::bo state_bos[2][2] = {{state_real_bo, state_imag_bo}, {output_real_bo, output_imag_bo}};
+    int src = 0;
+
+    // Kernel time of every gate, launch to completion
+    std::vector<double> kernel_us;
+    auto start = std::chrono::steady_clock::now();
 
   // Apply gates sequentially
     for (size_t i = 0; i < real_parts_list.size(); ++i) {
@@ -206,16 +234,13 @@ std::cout << std::endl;*/
         std::cout << "\n";*/
     
     
-        auto gate_real_map = gate_real_bo.map<half*>();
-        auto gate_imag_map = gate_imag_bo.map<half*>();
-        std::fill(gate_real_map, gate_real_map + 16, static_cast<half>(0.0));
-        std::fill(gate_imag_map, gate_imag_map + 16, static_cast<half>(0.0));
-        std::copy(real_parts_list[i].begin(), real_parts_list[i].end(), gate_real_map);
-        std::copy(imag_parts_list[i].begin(), imag_parts_list[i].end(), gate_imag_map);
-        
-
-        gate_real_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
-        gate_imag_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+        // Only single-qubit gates read their matrix, and only its 4 entries: upload just those
+        if (control_qubits[i] == -1) {
+            gate_real_bo.write(real_parts_list[i].data(), 4 * sizeof(half), 0);
+            gate_imag_bo.write(imag_parts_list[i].data(), 4 * sizeof(half), 0);
+            gate_real_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE, 4 * sizeof(half), 0);
+            gate_imag_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE, 4 * sizeof(half), 0);
+        }
         
         // Determine matrix size: 2x2 for single-qubit gates, 4x4 for two-qubit gates
     /*  size_t matrix_size = (control_qubits[i] == -1) ? 2 : 4; // Single-qubit if control is -1
@@ -239,33 +264,59 @@ std::cout << std::endl;*/
 
 
         // Run kernel
-        auto run = kernel(state_real_bo, state_imag_bo, gate_real_bo, gate_imag_bo, output_real_bo, output_imag_bo, control_qubits[i], target_qubits[i], num_qubits);
+        auto gate_start = std::chrono::steady_clock::now();
+        auto run = kernel(state_bos[src][0], state_bos[src][1], gate_real_bo, gate_imag_bo, state_bos[1 - src][0], state_bos[1 - src][1], control_qubits[i], target_qubits[i], num_qubits);
         run.wait();
+        kernel_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - gate_start).count());
+
+        // Swap input and output roles for the next gate
+        src = 1 - src;
 
-        // Synchronize back the output state vector
-        output_real_bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
-        output_imag_bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
-        
         // Print the updated state vector after applying the gate
-    /*std::cout << "State Vector (Iteration " << i << "):" << std::endl;
-    for (int j = 0; j < static_cast<int>(state_real.size()); ++j) {
-        std::cout << static_cast<float>(output_real_map[j]) << "+" << static_cast<float>(output_imag_map[j]) << "j ";
-        if ((j + 1) % 4 == 0) std::cout << std::endl;  // Print 4 elements per row for readability
+        if (debug_readback) {
+            state_bos[src][0].sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+            state_bos[src][1].sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+            auto debug_real_map = state_bos[src][0].map<half*>();
+            auto debug_imag_map = state_bos[src][1].map<half*>();
+            std::cout << "State Vector (Iteration " << i << "):" << std::endl;
+            for (int j = 0; j < static_cast<int>(state_real.size()); ++j) {
+                std::cout << static_cast<float>(debug_real_map[j]) << "+" << static_cast<float>(debug_imag_map[j]) << "j ";
+                if ((j + 1) % 4 == 0) std::cout << std::endl;  // Print 4 elements per row for readability
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Applied " << kernel_us.size() << " gates on the FPGA in " << seconds * 1e3 << " ms";
+    if (seconds > 0) {
+        std::cout << " (" << kernel_us.size() / seconds << " gates/s)";
     }
-    std::cout << std::endl;*/
+    std::cout << "\n";
 
-        // Replace input state vector with output state
-        std::copy(output_real_map, output_real_map + state_real.size(), state_real_map);
-        std::copy(output_imag_map, output_imag_map + state_imag.size(), state_imag_map);
-        state_real_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
-        state_imag_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+    if (!bench_file.empty()) {
+        std::ofstream bench(bench_file);
+        if (!bench.is_open()) {
+            std::cerr << "Unable to open " << bench_file << " for writing.\n";
+            return 1;
+        }
+        bench << "gate,control,target,kernel_us\n";
+        for (size_t i = 0; i < kernel_us.size(); ++i) {
+            bench << i << "," << control_qubits[i] << "," << target_qubits[i] << "," << kernel_us[i] << "\n";
+        }
     }
 
+    // Synchronize back the final state vector
+    state_bos[src][0].sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+    state_bos[src][1].sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+    auto final_real_map = state_bos[src][0].map<half*>();
+    auto final_imag_map = state_bos[src][1].map<half*>();
+
     // Write the final state vector
     std::ofstream outFile("final_state_vector.csv");
     if (outFile.is_open()) {
         for (int i = 0; i < static_cast<int>(state_real.size()); ++i) {
-            outFile << static_cast<float>(state_real_map[i]) << "+" << static_cast<float>(state_imag_map[i]) << "i\n";
+            outFile << static_cast<float>(final_real_map[i]) << "+" << static_cast<float>(final_imag_map[i]) << "i\n";
         }
         outFile.close();
         std::cout << "Final state vector written to final_state_vector.csv\n";
@@ -26,6 +26,20 @@ extern "C" {
 
         int num_states = 1 << num_qubits;
         int gate_size = (control == -1) ? 2 : 4;
+
+        // Load the 2x2 matrix into registers once per launch instead of reading the gate
+        // ports on every iteration (two-qubit gates do not use it)
+        half m_real[4];
+        half m_imag[4];
+#pragma HLS ARRAY_PARTITION variable=m_real complete
+#pragma HLS ARRAY_PARTITION variable=m_imag complete
+        if (gate_size == 2) {
+            matrix_loop: for (int e = 0; e < 4; ++e) {
+            #pragma HLS PIPELINE II=1
+                m_real[e] = gate_real[e];
+                m_imag[e] = gate_imag[e];
+            }
+        }
         
         // Single-qubit gate operation
         if (gate_size == 2) {
@@ -44,14 +58,14 @@ extern "C" {
                     half imag_flipped = state_imag[flipped_i];
 
                     // Calculate real and imaginary for output_state_vector[i]
-                    output_real[i] = gate_real[0 + target_bit] * real_i - gate_imag[0 + target_bit] * imag_i + gate_real[1 - target_bit] * real_flipped - gate_imag[1 - target_bit] * imag_flipped;
+                    output_real[i] = m_real[0 + target_bit] * real_i - m_imag[0 + target_bit] * imag_i + m_real[1 - target_bit] * real_flipped - m_imag[1 - target_bit] * imag_flipped;
 
-                    output_imag[i] = gate_real[0 + target_bit] * imag_i + gate_imag[0 + target_bit] * real_i + gate_real[1 - target_bit] * imag_flipped + gate_imag[1 - target_bit] * real_flipped;
+                    output_imag[i] = m_real[0 + target_bit] * imag_i + m_imag[0 + target_bit] * real_i + m_real[1 - target_bit] * imag_flipped + m_imag[1 - target_bit] * real_flipped;
 
                     // Calculate real and imaginary for output_state_vector[flipped_i]
-                    output_real[flipped_i] = gate_real[2 + target_bit] * real_i - gate_imag[2 + target_bit] * imag_i + gate_real[3 - target_bit] * real_flipped - gate_imag[3 - target_bit] * imag_flipped;
+                    output_real[flipped_i] = m_real[2 + target_bit] * real_i - m_imag[2 + target_bit] * imag_i + m_real[3 - target_bit] * real_flipped - m_imag[3 - target_bit] * imag_flipped;
 
-                    output_imag[flipped_i] = gate_real[2 + target_bit] * imag_i + gate_imag[2 + target_bit] * real_i + gate_real[3 - target_bit] * imag_flipped + gate_imag[3 - target_bit] * real_flipped;
+                    output_imag[flipped_i] = m_real[2 + target_bit] * imag_i + m_imag[2 + target_bit] * real_i + m_real[3 - target_bit] * imag_flipped + m_imag[3 - target_bit] * real_flipped;
                                            
                 }
             }